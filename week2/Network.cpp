@@ -1,4 +1,8 @@
-#include "lib.h"
+// 할당기와 공용 선언은 New/lib.h 에만 있음 (week2/lib.h 는 이것을 포함하기만 함)
+#include "New/lib.h"
+#include "New/HttpParser.h"
+#include "New/Router.h"
+#include "New/SendQueue.h"
 #include <fstream>
 #include <sstream>
 
@@ -6,7 +10,7 @@ using namespace std;
 
 // 파일을 읽어서 문자열로 반환하는 함수
 string readFileToString(const string& filename) {
-    ifstream file(filename); // 파일 열기
+    ifstream file(filename, ios::binary); // 파일 열기 (Content-Length 와 맞도록 바이너리 모드)
     stringstream ss; // 문자열 스트림 생성
     if (!file.is_open()) { // 파일이 열리지 않은 경우
         cerr << "Unable to open file: " << filename << endl;
@@ -16,6 +20,237 @@ string readFileToString(const string& filename) {
     return ss.str(); // 스트림을 문자열로 반환
 }
 
+// 파일을 메모리에 복사하지 않고 매핑해서 보여주는 클래스
+// 매핑된 영역은 OS 페이지 캐시를 그대로 가리키므로 큰 파일도 사용자 영역 복사 없이 바로 보낼 수 있다
+class MappedFile {
+    HANDLE file;
+    HANDLE mapping;
+    const char* view;
+    size_t length;
+
+public:
+    explicit MappedFile(const string& filename) : file(INVALID_HANDLE_VALUE), mapping(NULL), view(nullptr), length(0) {
+        // 매핑 중에도 다른 프로그램이 파일을 수정/삭제할 수 있도록 공유 모드로 연다
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { // 0 바이트 파일은 매핑할 수 없음
+            return;
+        }
+
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            return;
+        }
+
+        view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view != nullptr) {
+            length = static_cast<size_t>(size.QuadPart);
+        }
+    }
+
+    ~MappedFile() {
+        if (view != nullptr) UnmapViewOfFile(view);
+        if (mapping != NULL) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return view; }
+    size_t size() const { return length; }
+};
+
+// 페이지를 HTTP 헤더까지 만들어서 메모리에 보관하는 캐시
+// 파일은 처음 요청될 때 한 번만 읽고, 디렉터리 변경 알림이 왔을 때만 수정 시각을 비교해서 다시 읽는다
+// 큰 파일은 본문을 캐시에 올리지 않고 보낼 때마다 매핑해서 보낸다 (메모리 사용량이 파일 크기만큼 늘지 않음)
+// 헤더와 본문은 shared_ptr 로 들고 있어서, 보내는 도중 파일이 다시 읽혀도 송신 대기열이 가리키는 이전 내용은 남아 있다
+class PageCache {
+    struct Entry {
+        string status;                   // 상태 줄 (예: "200 OK")
+        shared_ptr<const string> header; // 작은 파일의 HTTP 헤더
+        shared_ptr<const string> body;   // 작은 파일의 본문
+        bool mapped;                     // true 면 큰 파일 (보낼 때 매핑)
+        FILETIME lastWrite;              // 읽었을 때의 파일 수정 시각
+    };
+
+    unordered_map<string, Entry> entries; // 파일 이름 -> 캐시된 응답
+    HANDLE changeHandle; // 현재 디렉터리의 변경 알림 핸들
+    ULONGLONG nextCheck; // 변경 알림을 못 쓰는 경우 다음 확인 시각
+
+    // 변경 알림을 쓸 수 없을 때 수정 시각을 확인하는 간격 (밀리초)
+    static constexpr ULONGLONG FALLBACK_CHECK_MS = 1000;
+    // 이 크기 이상인 파일은 캐시에 올리지 않고 매핑해서 보냄
+    static constexpr ULONGLONG LARGE_FILE_SIZE = 256 * 1024;
+
+    // Connection 헤더와 빈 줄은 요청마다 다르므로 따로 붙인다
+    static string makeHeader(const string& status, size_t contentLength) {
+        return "HTTP/1.1 " + status + "\r\nContent-Type: text/html\r\nContent-Length: " + to_string(contentLength) + "\r\n";
+    }
+
+    static void load(const string& filename, Entry& entry) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &data)) {
+            memset(&data, 0, sizeof(data)); // 파일이 없으면 0 (빈 본문으로 응답)
+        }
+        entry.lastWrite = data.ftLastWriteTime;
+
+        ULONGLONG fileSize = (static_cast<ULONGLONG>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        entry.mapped = fileSize >= LARGE_FILE_SIZE;
+        if (entry.mapped) {
+            entry.header.reset();
+            entry.body.reset();
+            return;
+        }
+
+        entry.body = make_shared<const string>(readFileToString(filename));
+        entry.header = make_shared<const string>(makeHeader(entry.status, entry.body->size()));
+    }
+
+    static FILETIME lastWriteTime(const string& filename) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &data)) {
+            return FILETIME{ 0, 0 }; // 파일이 없으면 0
+        }
+        return data.ftLastWriteTime;
+    }
+
+    // 파일이 바뀌었을 수도 있으면 캐시된 파일들의 수정 시각을 비교해서 바뀐 것만 다시 읽음
+    void revalidate() {
+        if (changeHandle != INVALID_HANDLE_VALUE) {
+            // 대기하지 않고 알림이 왔는지만 확인 (파일 시스템은 건드리지 않음)
+            if (WaitForSingleObject(changeHandle, 0) != WAIT_OBJECT_0) {
+                return;
+            }
+            FindNextChangeNotification(changeHandle); // 다음 알림을 받기 위해 다시 등록
+        } else {
+            ULONGLONG now = GetTickCount64();
+            if (now < nextCheck) {
+                return;
+            }
+            nextCheck = now + FALLBACK_CHECK_MS;
+        }
+
+        for (auto& [filename, entry] : entries) {
+            FILETIME current = lastWriteTime(filename);
+            if (CompareFileTime(&entry.lastWrite, &current) != 0) {
+                cout << "Reloading " << filename << endl;
+                load(filename, entry);
+            }
+        }
+    }
+
+    // 큰 파일을 매핑해서 헤더와 함께 송신 대기열에 넣음 (매핑은 본문을 다 보낼 때까지 유지)
+    static void queueMapped(SendQueue& queue, const string& filename, const string& status, bool keepAlive) {
+        auto file = make_shared<const MappedFile>(filename);
+        // 보내는 도중 파일이 바뀌어도 헤더가 어긋나지 않도록 실제로 매핑된 크기로 헤더를 만든다
+        string header = makeHeader(status, file->size());
+        string_view connectionHeader = httpConnectionHeader(keepAlive);
+
+        queue.pushCopy(header.data(), header.size());
+        queue.pushRef(connectionHeader.data(), connectionHeader.size());
+        queue.pushRef(file->data(), file->size(), file);
+    }
+
+public:
+    PageCache() : nextCheck(0) {
+        changeHandle = FindFirstChangeNotificationA(".", FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+    }
+
+    ~PageCache() {
+        if (changeHandle != INVALID_HANDLE_VALUE) {
+            FindCloseChangeNotification(changeHandle);
+        }
+    }
+
+    // 페이지를 클라이언트의 송신 대기열에 넣음 (처음 요청된 파일이면 읽어서 캐시에 추가)
+    // 헤더와 본문은 하나의 문자열로 합치지 않고 캐시를 가리키는 조각으로 넣어서 WSASend 한 번에 모아 보낸다
+    void queue(SendQueue& queue, const string& filename, const char* status, bool keepAlive) {
+        revalidate();
+
+        auto it = entries.find(filename);
+        if (it == entries.end()) {
+            it = entries.emplace(filename, Entry{ status, nullptr, nullptr, false, FILETIME{ 0, 0 } }).first;
+            load(filename, it->second);
+        }
+
+        Entry& entry = it->second;
+        if (entry.mapped) {
+            queueMapped(queue, filename, entry.status, keepAlive);
+            return;
+        }
+
+        string_view connectionHeader = httpConnectionHeader(keepAlive);
+        queue.pushRef(entry.header->data(), entry.header->size(), entry.header);
+        queue.pushRef(connectionHeader.data(), connectionHeader.size());
+        queue.pushRef(entry.body->data(), entry.body->size(), entry.body);
+    }
+};
+
+// 연결된 클라이언트 (keep-alive 로 여러 요청을 주고받는 동안 유지됨)
+struct Client {
+    SOCKET sock;                 // 클라이언트 소켓
+    string request;              // 아직 처리하지 않은 수신 데이터 (파이프라이닝된 요청이 여러 개 들어있을 수 있음)
+    ULONGLONG deadline;          // 이 시각까지 다음 요청이 완성되지 않거나 응답이 빠지지 않으면 연결을 끊음
+    HttpParser parser;           // request 맨 앞 요청을 어디까지 확인했는지 기억
+    SendQueue out;               // 아직 보내지 못한 응답
+    bool closeAfterSend = false; // 남은 응답을 다 보내면 연결을 닫음 (Connection: close, 잘못된 요청)
+};
+
+// 요청을 다 받기까지 기다려주는 최대 시간 (밀리초)
+constexpr ULONGLONG READ_TIMEOUT_MS = 5000;
+// 응답 후 다음 요청을 기다려주는 최대 시간 (밀리초)
+constexpr ULONGLONG KEEP_ALIVE_TIMEOUT_MS = 5000;
+// 보내지 못한 응답이 이 시간 동안 조금도 빠지지 않으면 연결을 끊음 (밀리초)
+constexpr ULONGLONG SEND_TIMEOUT_MS = 5000;
+// 한 클라이언트에 보내지 못한 응답이 이만큼 쌓이면 다 빠질 때까지 그 클라이언트의 요청을 읽지 않음 (바이트)
+constexpr size_t SEND_HIGH_WATER_MARK = 256 * 1024;
+
+// 경로마다 보낼 파일
+struct FilePage {
+    const char* filename;
+    const char* status;
+};
+
+// 경로 테이블 (컴파일 타임에 해시 테이블로 만들어져서 경로가 늘어나도 한 번에 찾음)
+constexpr Route<FilePage> ROUTES[] = {
+    { "/", { "index.html", "200 OK" } },
+    { "/Find", { "Find.html", "200 OK" } },
+    { "/about", { "about.html", "200 OK" } },
+    { "/Goku", { "Goku.html", "200 OK" } },
+    { "/Vegeta", { "Vegeta.html", "200 OK" } },
+};
+constexpr auto ROUTE_TABLE = makeRouteTable(ROUTES);
+constexpr FilePage NOT_FOUND_PAGE = { "404.html", "404 Not Found" };
+
+// 요청을 파싱하지 못했을 때 에러 응답을 송신 대기열에 넣는 함수
+void sendError(SendQueue& out, const char* status) {
+    string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    out.pushCopy(response.data(), response.size());
+}
+
+// 요청 하나에 맞는 페이지를 송신 대기열에 넣고, 연결을 계속 유지할지 반환하는 함수
+bool respond(SendQueue& out, const HttpRequest& request, PageCache& pages) {
+    // 클라이언트 요청 출력
+    cout << "Request: " << request.method << " " << request.path << " " << request.version << endl;
+
+    // 경로 테이블에서 한 번에 찾음 (GET 이 아니거나 없는 경로면 404)
+    int index = request.method == "GET" ? ROUTE_TABLE.find(request.path) : -1;
+    const FilePage& page = index >= 0 ? ROUTE_TABLE[index].target : NOT_FOUND_PAGE;
+
+    // 캐시에 헤더까지 만들어져 있으므로 요청마다 파일을 열거나 문자열을 새로 만들지 않음
+    pages.queue(out, page.filename, page.status, request.keepAlive);
+    return request.keepAlive;
+}
+
 int main() {
     // 네트워크 라이브러리 초기화
     WSAData wsaData;
@@ -42,117 +277,171 @@ int main() {
     servaddr.sin_addr.s_addr = htonl(INADDR_ANY); // 서버의 IP 주소 설정
     servaddr.sin_port = htons(12345); // 서버의 포트 번호 설정 (12345번 포트 사용)
 
-    // 논블로킹 소켓은 bind()에서도 루프를 돌면서 될 때까지 계속 시도해야함 
-    // 클라이언트가 접속을 끊었을 때, 서버가 바인딩을 해제하고 다시 바인딩을 시도해야함
-    while (bind(servsock, (SOCKADDR*)&servaddr, sizeof(servaddr)) == SOCKET_ERROR) {
-        if (WSAGetLastError() == WSAEWOULDBLOCK) {
-            // 논블로킹 소켓에서는 루프를 돌며 다시 시도
-            continue;
-        } else {
-            cout << "bind() error" << endl;
-            return 0;
-        }
+    // bind(), listen() 은 논블로킹 소켓이어도 기다릴 일이 없으므로 한 번만 호출
+    if (bind(servsock, (SOCKADDR*)&servaddr, sizeof(servaddr)) == SOCKET_ERROR) {
+        cout << "bind() error" << endl;
+        return 0;
     }
 
-    // 논블로킹 소켓은 listen()에서도 루프를 돌면서 될 때까지 계속 시도해야함
-    while (listen(servsock, SOMAXCONN) == SOCKET_ERROR) {
-        if (WSAGetLastError() == WSAEWOULDBLOCK) {
-            // 논블로킹 소켓에서는 루프를 돌며 다시 시도
-            continue;
-        } else {
-            cout << "listen() error" << endl;
-            return 0;
-        }
+    if (listen(servsock, SOMAXCONN) == SOCKET_ERROR) {
+        cout << "listen() error" << endl;
+        return 0;
     }
 
-    // 클라이언트 연결 대기
+    // 페이지 캐시
+    PageCache pages;
+
+    // 연결된 클라이언트 목록
+    vector<Client> clients;
+    // WSAPoll 로 감시할 소켓 목록 (0번은 서버 소켓, 1번부터는 clients 와 같은 순서)
+    vector<WSAPOLLFD> fds;
+
     while (true) {
-        SOCKADDR_IN cliaddr;
-        int addrlen = sizeof(cliaddr);
-        SOCKET clisock = accept(servsock, (SOCKADDR*)&cliaddr, &addrlen);
-        //클라이언트 연결 요청 수락
-        if (clisock == INVALID_SOCKET) {
-            if (WSAGetLastError() == WSAEWOULDBLOCK) {
-                // 논블로킹 소켓에서는 루프를 돌며 다시 시도
-                continue;
-            } else { 
-                cout << "accept() error" << endl;
-                return 0;
+        fds.clear();
+        fds.push_back({ servsock, POLLRDNORM, 0 });
+        for (const Client& client : clients) {
+            // 남은 응답이 있으면 쓰기 가능해질 때도 깨어나고, 너무 많이 쌓였거나 닫을 연결이면 읽기를 멈춤 (backpressure)
+            SHORT events = 0;
+            if (!client.closeAfterSend && client.out.pendingBytes() < SEND_HIGH_WATER_MARK) {
+                events |= POLLRDNORM;
+            }
+            if (!client.out.empty()) {
+                events |= POLLWRNORM;
             }
+            fds.push_back({ client.sock, events, 0 });
         }
 
-        // 클라이언트 연결 성공
-        cout << "Client Connected" << endl;
+        // 가장 먼저 마감되는 클라이언트의 시각까지만 대기 (클라이언트가 없으면 무한 대기)
+        ULONGLONG now = GetTickCount64();
+        int timeout = -1;
+        for (const Client& client : clients) {
+            int remain = client.deadline > now ? static_cast<int>(client.deadline - now) : 0;
+            if (timeout < 0 || remain < timeout) {
+                timeout = remain;
+            }
+        }
+
+        // 소켓이 준비될 때까지 CPU 를 쓰지 않고 대기
+        if (WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout) == SOCKET_ERROR) {
+            cout << "WSAPoll() error" << endl;
+            break;
+        }
 
-        // 클라이언트 요청 읽기 버퍼 생성
-        char buf[1024] = "";
+        // 준비된 클라이언트의 요청을 읽고 응답을 보냄
+        // 뒤에서부터 돌면서 끝난 클라이언트는 마지막 원소와 자리를 바꿔 제거
+        now = GetTickCount64();
+        for (size_t i = clients.size(); i-- > 0; ) {
+            Client& client = clients[i];
+            bool finished = false;
+            SHORT revents = fds[i + 1].revents;
 
-        // 클라이언트 요청 읽기 (정상적인 값이 들어올 때까지 루프)
-        int recvlen = 0;
-        // 클라이언트 요청을 저장할 변수
-        string request = "";
-        while(true){
-            recvlen = recv(clisock, buf, sizeof(buf), 0);
-            if (recvlen == SOCKET_ERROR) { // 에러 발생
-                // 논블로킹 소켓은 revc()에서도 루프를 돌면서 될 때까지 계속 시도해야함
-                if (WSAGetLastError() == WSAEWOULDBLOCK) {
-                    continue;
+            // 상대가 끊었거나 (POLLHUP) 에러가 난 경우도 recv 로 확인해서 정리
+            if (revents & (POLLRDNORM | POLLHUP | POLLERR)) {
+                // 클라이언트 요청 읽기 버퍼 생성
+                char buf[1024] = "";
+                int recvlen = recv(client.sock, buf, sizeof(buf), 0);
+                if (recvlen == SOCKET_ERROR) { // 에러 발생
+                    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                        cout << "recv() error" << endl;
+                        closesocket(client.sock);
+                        finished = true;
+                    }
+                } else if (recvlen == 0) { // 클라이언트 연결 종료
+                    cout << "Client Disconnected" << endl;
+                    closesocket(client.sock);
+                    finished = true;
                 } else {
-                    cout << "recv() error" << endl;
-                    break;
-                }
-            } else if (recvlen == 0) { // 클라이언트 연결 종료
-                cout << "Client Disconnected" << endl;
-                closesocket(clisock);
-                break; // 클라이언트 연결 종료 시 루프 종료
-            } else {
-                // 클라이언트 요청을 request에 추가
-                request += string(buf, recvlen);
-                // 정상적인 요청인지 확인
-                if (request.find("\r\n\r\n") != string::npos) {
-                    // 정상적인 요청이 완료된 경우 응답을 보내고 루프 종료
-                    break;
+                    // 클라이언트 요청을 request에 추가
+                    client.request.append(buf, recvlen);
                 }
             }
-        }
-        
-        // 클라이언트의 요청이 있을 경우
-        if (!request.empty()) {
-            // 클라이언트 요청 출력
-            cout << "Request: " << request << endl;
-
-            string response = "";
-            if(strstr(request.c_str(), "GET / HTTP/1.1") != NULL) {
-                response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("index.html");
-            } else if(strstr(request.c_str(), "GET /Find HTTP/1.1") != NULL) {
-                response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("Find.html");
-            }
-            else if(strstr(request.c_str(), "GET /about HTTP/1.1") != NULL) {
-                response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("about.html");
+
+            if (!finished && revents != 0) {
+                // 완성된 요청이 있는 동안 차례대로 응답을 쌓음 (파이프라이닝)
+                // 보내지 못한 응답이 SEND_HIGH_WATER_MARK 를 넘으면 나머지 요청은 응답이 빠진 뒤에 처리
+                HttpRequest request;
+                size_t consumed = 0;
+                while (!client.closeAfterSend && client.out.pendingBytes() < SEND_HIGH_WATER_MARK) {
+                    size_t used = 0;
+                    HttpParseResult result = client.parser.parse(client.request.data() + consumed,
+                        client.request.size() - consumed, request, used);
+                    if (result == HttpParseResult::Incomplete) {
+                        break;
+                    }
+                    if (result != HttpParseResult::Complete) {
+                        // 잘못된 요청은 에러를 알리고 다 보내면 연결 종료
+                        sendError(client.out, httpErrorStatus(result));
+                        cout << "Bad Request" << endl;
+                        client.closeAfterSend = true;
+                        break;
+                    }
+
+                    consumed += used;
+                    if (!respond(client.out, request, pages)) {
+                        // keep-alive 가 아니면 응답을 다 보낸 뒤 연결 종료
+                        client.closeAfterSend = true;
+                    }
+                }
+
+                if (consumed > 0) {
+                    // 응답한 요청은 버퍼에서 지우고 다음 요청을 기다림
+                    client.request.erase(0, consumed);
+                    client.deadline = now + KEEP_ALIVE_TIMEOUT_MS;
+                }
+
+                // 쌓인 응답을 보낼 수 있는 만큼 보냄 (송신 버퍼가 차면 남겨 두고 쓰기 가능해질 때 이어서 보냄)
+                size_t pending = client.out.pendingBytes();
+                SendQueue::FlushResult result = client.out.flush(client.sock);
+                if (result == SendQueue::FlushResult::Error) {
+                    cout << "send() error" << endl;
+                    closesocket(client.sock);
+                    finished = true;
+                } else if (result == SendQueue::FlushResult::Done && client.closeAfterSend) {
+                    closesocket(client.sock);
+                    cout << "Client Disconnected" << endl;
+                    finished = true;
+                } else if (!client.out.empty() && client.out.pendingBytes() < pending) {
+                    // 느려도 받아 가고 있는 클라이언트는 끊지 않음
+                    client.deadline = max(client.deadline, now + SEND_TIMEOUT_MS);
+                }
             }
-            else if(strstr(request.c_str(), "GET /Goku HTTP/1.1") != NULL) {
-                response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("Goku.html");
+
+            // 제한 시간 안에 다음 요청을 다 보내지 않거나 응답을 받아 가지 않는 클라이언트는 끊어서 다른 클라이언트를 막지 않도록 함
+            if (!finished && now >= client.deadline) {
+                cout << "Client Timed Out" << endl;
+                closesocket(client.sock);
+                finished = true;
             }
-            else if(strstr(request.c_str(), "GET /Vegeta HTTP/1.1") != NULL) {
-                response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("Vegeta.html");
+
+            if (finished) {
+                clients[i] = move(clients.back());
+                clients.pop_back();
             }
-            else {
-                response = "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\n\r\n";
-                response += readFileToString("404.html");
+        }
+
+        // 대기 중인 연결 요청을 모두 수락
+        if (fds[0].revents != 0) {
+            while (true) {
+                SOCKADDR_IN cliaddr;
+                int addrlen = sizeof(cliaddr);
+                SOCKET clisock = accept(servsock, (SOCKADDR*)&cliaddr, &addrlen);
+                if (clisock == INVALID_SOCKET) {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                        cout << "accept() error" << endl;
+                    }
+                    break;
+                }
+
+                // 클라이언트 연결 성공
+                cout << "Client Connected" << endl;
+                clients.push_back({ clisock, "", GetTickCount64() + READ_TIMEOUT_MS, HttpParser(), SendQueue() });
             }
-            send(clisock, response.c_str(), response.length(), 0);
         }
-        
-        // 클라이언트 연결 닫기
-        closesocket(clisock);
-        cout << "Client Disconnected" << endl;
     }
 
+    for (const Client& client : clients) {
+        closesocket(client.sock);
+    }
     closesocket(servsock); // 서버 소켓 닫기
 
     WSACleanup();
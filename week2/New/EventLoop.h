@@ -0,0 +1,123 @@
+#pragma once
+
+#include <WinSock2.h>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+// 소켓 준비 상태 (비트 플래그)
+enum IoEvent : uint32_t {
+    IO_READ = 1 << 0,  // 읽을 데이터가 있음 (리슨 소켓이면 accept 가능)
+    IO_WRITE = 1 << 1, // 송신 버퍼에 여유가 생김
+    IO_ERROR = 1 << 2, // 소켓 에러
+};
+
+struct IoReady {
+    SOCKET socket;
+    uint32_t events;
+};
+
+// 준비된 소켓만 돌려주는 이벤트 루프 인터페이스
+// 모든 소켓에 recv 를 돌려보는 대신 커널이 알려준 소켓만 처리하고, 할 일이 없으면 wait() 에서 잠든다
+// (준비된 소켓만 recv 를 부르는 것이지, wait() 자체의 비용이 연결 수와 무관하다는 뜻은 아님: 구현마다 다름)
+class EventLoop {
+public:
+    virtual ~EventLoop() = default;
+
+    virtual bool add(SOCKET socket, uint32_t events) = 0;
+    virtual bool modify(SOCKET socket, uint32_t events) = 0;
+    virtual void remove(SOCKET socket) = 0;
+
+    // 최대 timeoutMs 동안 대기 (-1 이면 무한 대기)
+    // 준비된 소켓을 ready 에 채우고 그 개수를 반환, 실패하면 -1
+    virtual int wait(std::vector<IoReady>& ready, int timeoutMs) = 0;
+};
+
+// WSAPoll 기반 구현 (Windows 에는 epoll 이 없으므로 준비 상태 통지는 WSAPoll 을 사용)
+// 주의: WSAPoll 은 매번 등록된 소켓 배열 전체를 커널에 넘기고, 돌아온 배열도 처음부터 훑어야 하므로
+// wait() 한 번의 비용은 준비된 소켓 수가 아니라 등록된 연결 수에 비례한다 (O(연결 수))
+// index 는 add/remove 만 O(1) 로 만들 뿐 이 비용은 줄이지 못함
+// 연결 수가 늘어도 요청당 비용이 늘지 않아야 하면 완료 통지 방식 (IoEngine::Completion, I/O completion port) 을 쓸 것
+class WSAPollLoop : public EventLoop {
+    std::vector<WSAPOLLFD> fds;
+    std::unordered_map<SOCKET, size_t> index; // 소켓 -> fds 위치 (추가/삭제를 O(1) 로)
+
+    static SHORT toPollEvents(uint32_t events) {
+        SHORT pollEvents = 0;
+        if (events & IO_READ) pollEvents |= POLLRDNORM;
+        if (events & IO_WRITE) pollEvents |= POLLWRNORM;
+        return pollEvents;
+    }
+
+public:
+    bool add(SOCKET socket, uint32_t events) override {
+        if (index.count(socket)) {
+            return false;
+        }
+
+        WSAPOLLFD fd;
+        fd.fd = socket;
+        fd.events = toPollEvents(events);
+        fd.revents = 0;
+        index[socket] = fds.size();
+        fds.push_back(fd);
+        return true;
+    }
+
+    bool modify(SOCKET socket, uint32_t events) override {
+        auto it = index.find(socket);
+        if (it == index.end()) {
+            return false;
+        }
+
+        fds[it->second].events = toPollEvents(events);
+        return true;
+    }
+
+    void remove(SOCKET socket) override {
+        auto it = index.find(socket);
+        if (it == index.end()) {
+            return;
+        }
+
+        // 마지막 원소를 빈자리로 옮겨서 배열을 당기지 않고 삭제
+        size_t pos = it->second;
+        index.erase(it);
+        if (pos != fds.size() - 1) {
+            fds[pos] = fds.back();
+            index[fds[pos].fd] = pos;
+        }
+        fds.pop_back();
+    }
+
+    int wait(std::vector<IoReady>& ready, int timeoutMs) override {
+        ready.clear();
+
+        int count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+        if (count == SOCKET_ERROR) {
+            return -1;
+        }
+
+        // 준비된 개수만큼 찾으면 바로 멈춘다 (그래도 최악에는 배열 끝까지 훑음)
+        for (size_t i = 0; i < fds.size() && static_cast<int>(ready.size()) < count; i++) {
+            SHORT revents = fds[i].revents;
+            if (revents == 0) {
+                continue;
+            }
+
+            uint32_t events = 0;
+            // 상대가 연결을 끊은 경우(POLLHUP)도 읽기로 알려서 recv() 가 0 을 받고 정리하도록 한다
+            if (revents & (POLLRDNORM | POLLHUP)) events |= IO_READ;
+            if (revents & POLLWRNORM) events |= IO_WRITE;
+            if (revents & (POLLERR | POLLNVAL)) events |= IO_ERROR;
+            ready.push_back({ fds[i].fd, events });
+        }
+
+        return static_cast<int>(ready.size());
+    }
+};
+
+inline std::unique_ptr<EventLoop> createEventLoop() {
+    return std::make_unique<WSAPollLoop>();
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+// 헤더 한 줄 (name: value)
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// 파싱된 요청, 모든 필드는 수신 버퍼를 가리키는 string_view (버퍼를 바꾸기 전까지만 유효)
+struct HttpRequest {
+    static constexpr size_t MAX_HEADERS = 32;
+
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    HttpHeader headers[MAX_HEADERS];
+    size_t headerCount = 0;
+    std::string_view body;
+    size_t contentLength = 0;
+    bool keepAlive = false;
+
+    // 이름으로 헤더 값을 찾음 (대소문자 무시, 없으면 빈 값)
+    std::string_view header(std::string_view name) const;
+};
+
+enum class HttpParseResult {
+    Complete,   // 요청 하나가 완성됨
+    Incomplete, // 데이터가 더 필요함
+    Invalid,      // 형식이 잘못된 요청 (400)
+    TooLarge,     // 헤더가 제한보다 큼 (431)
+    BodyTooLarge, // 본문이 제한보다 큼 (413)
+};
+
+// 파싱에 실패했을 때 돌려줄 상태 줄
+inline const char* httpErrorStatus(HttpParseResult result) {
+    switch (result) {
+    case HttpParseResult::TooLarge: return "431 Request Header Fields Too Large";
+    case HttpParseResult::BodyTooLarge: return "413 Content Too Large";
+    default: return "400 Bad Request";
+    }
+}
+
+// 응답 헤더의 마지막 줄 (Connection 헤더 + 빈 줄)
+inline std::string_view httpConnectionHeader(bool keepAlive) {
+    return keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+}
+
+// 여러 번의 recv 에 나눠 도착하는 요청을 이어서 파싱하는 파서
+// 같은 요청에 대해 데이터가 늘어날 때마다 parse() 를 다시 부르면 이전에 확인한 위치부터 이어서 찾는다
+// 문자열을 새로 만들지 않고 수신 버퍼 안을 가리키는 string_view 만 돌려준다
+class HttpParser {
+public:
+    static constexpr size_t MAX_HEADER_SIZE = 8192;
+    static constexpr size_t MAX_BODY_SIZE = 1024 * 1024;
+
+    // data 는 요청의 시작부터 지금까지 받은 데이터
+    // Complete 이면 consumed 에 이 요청이 차지한 바이트 수 (헤더 + 본문) 를 넣고, 다음 요청을 위해 상태를 초기화한다
+    HttpParseResult parse(const char* data, size_t length, HttpRequest& request, size_t& consumed);
+
+    void reset() {
+        scanned = 0;
+        headerLength = 0;
+    }
+
+private:
+    size_t scanned = 0;      // 헤더 끝(\r\n\r\n) 을 이미 찾아본 위치
+    size_t headerLength = 0; // 헤더 끝을 찾았으면 빈 줄까지 포함한 헤더 길이 (본문을 기다리는 중)
+
+    HttpParseResult parseHeader(const char* data, HttpRequest& request) const;
+};
+
+inline bool httpEqualsNoCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::string_view HttpRequest::header(std::string_view name) const {
+    for (size_t i = 0; i < headerCount; i++) {
+        if (httpEqualsNoCase(headers[i].name, name)) {
+            return headers[i].value;
+        }
+    }
+    return std::string_view();
+}
+
+// RFC 9110 의 token 문자 (메서드와 헤더 이름에 쓸 수 있는 문자) 표
+struct HttpTokenTable {
+    bool allowed[256] = {};
+
+    constexpr HttpTokenTable() {
+        for (int c = '0'; c <= '9'; c++) allowed[c] = true;
+        for (int c = 'a'; c <= 'z'; c++) allowed[c] = true;
+        for (int c = 'A'; c <= 'Z'; c++) allowed[c] = true;
+        const char symbols[] = "!#$%&'*+-.^_`|~";
+        for (size_t i = 0; i + 1 < sizeof(symbols); i++) allowed[static_cast<unsigned char>(symbols[i])] = true;
+    }
+};
+
+inline bool httpIsTokenChar(char c) {
+    static constexpr HttpTokenTable table;
+    return table.allowed[static_cast<unsigned char>(c)];
+}
+
+inline HttpParseResult HttpParser::parse(const char* data, size_t length, HttpRequest& request, size_t& consumed) {
+    if (headerLength == 0) {
+        // 지난번에 본 곳에서 3 바이트 앞부터 찾아서 \r\n\r\n 이 두 번의 recv 에 걸쳐 있어도 찾을 수 있게 함
+        // 헤더 끝을 못 찾은 채로 제한보다 많이 받았으면, 앞으로 헤더 끝이 오더라도 제한을 넘으므로 데이터를 더 기다리지 않고 거부
+        size_t pos = scanned >= 3 ? scanned - 3 : 0;
+        while (true) {
+            const void* cr = pos < length ? std::memchr(data + pos, '\r', length - pos) : nullptr;
+            if (cr == nullptr) {
+                scanned = length;
+                if (length > MAX_HEADER_SIZE) {
+                    reset();
+                    return HttpParseResult::TooLarge;
+                }
+                return HttpParseResult::Incomplete;
+            }
+
+            pos = static_cast<const char*>(cr) - data;
+            if (pos + 4 > length) {
+                if (length > MAX_HEADER_SIZE) {
+                    reset();
+                    return HttpParseResult::TooLarge;
+                }
+                scanned = pos; // 끝에 \r 이 걸려 있으면 다음 데이터와 합쳐서 다시 확인
+                return HttpParseResult::Incomplete;
+            }
+            if (std::memcmp(data + pos, "\r\n\r\n", 4) == 0) {
+                headerLength = pos + 4;
+                break;
+            }
+            pos++;
+        }
+
+        if (headerLength > MAX_HEADER_SIZE) {
+            reset();
+            return HttpParseResult::TooLarge;
+        }
+    }
+
+    HttpParseResult result = parseHeader(data, request);
+    if (result != HttpParseResult::Complete) {
+        reset();
+        return result;
+    }
+
+    if (length - headerLength < request.contentLength) {
+        return HttpParseResult::Incomplete; // 본문이 아직 다 오지 않음 (헤더 끝 위치는 기억해 둠)
+    }
+
+    request.body = std::string_view(data + headerLength, request.contentLength);
+    consumed = headerLength + request.contentLength;
+    reset();
+    return HttpParseResult::Complete;
+}
+
+inline HttpParseResult HttpParser::parseHeader(const char* data, HttpRequest& request) const {
+    // 마지막 헤더 줄의 \r\n 과 빈 줄은 빼고 본다
+    std::string_view text(data, headerLength - 4);
+
+    // 요청 줄: METHOD SP PATH SP VERSION CRLF
+    size_t lineEnd = text.find("\r\n");
+    std::string_view line = text.substr(0, lineEnd);
+
+    size_t sp1 = line.find(' ');
+    size_t sp2 = sp1 == std::string_view::npos ? std::string_view::npos : line.find(' ', sp1 + 1);
+    if (sp1 == 0 || sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+        return HttpParseResult::Invalid;
+    }
+
+    request.method = line.substr(0, sp1);
+    request.path = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    request.version = line.substr(sp2 + 1);
+
+    for (char c : request.method) {
+        if (!httpIsTokenChar(c)) {
+            return HttpParseResult::Invalid;
+        }
+    }
+    for (char c : request.path) {
+        if (static_cast<unsigned char>(c) <= ' ' || c == 0x7f) {
+            return HttpParseResult::Invalid;
+        }
+    }
+    if (request.path[0] != '/' && request.path != "*") {
+        return HttpParseResult::Invalid;
+    }
+    if (request.version != "HTTP/1.1" && request.version != "HTTP/1.0") {
+        return HttpParseResult::Invalid;
+    }
+
+    // 헤더 줄: NAME ":" OWS VALUE OWS CRLF
+    request.headerCount = 0;
+    request.contentLength = 0;
+    request.keepAlive = request.version == "HTTP/1.1";
+    bool hasContentLength = false;
+
+    while (lineEnd != std::string_view::npos) {
+        size_t lineStart = lineEnd + 2;
+
+        // 이름은 token 문자로만 되어 있고 바로 뒤에 ':' 가 와야 함 (여러 줄에 걸친 옛날 형식 헤더도 여기서 거부)
+        size_t colon = lineStart;
+        while (colon < text.size() && httpIsTokenChar(text[colon])) {
+            colon++;
+        }
+        if (colon == lineStart || colon == text.size() || text[colon] != ':') {
+            return HttpParseResult::Invalid;
+        }
+        std::string_view name = text.substr(lineStart, colon - lineStart);
+
+        // 줄 끝은 반드시 \r\n
+        const void* cr = std::memchr(text.data() + colon, '\r', text.size() - colon);
+        lineEnd = cr == nullptr ? std::string_view::npos : static_cast<const char*>(cr) - text.data();
+        if (lineEnd != std::string_view::npos && (lineEnd + 1 >= text.size() || text[lineEnd + 1] != '\n')) {
+            return HttpParseResult::Invalid;
+        }
+        line = text.substr(colon, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - colon);
+        // 값 안의 \r 없는 \n 이나 NUL 은 요청 경계를 다르게 읽는 프록시와 어긋날 수 있으므로 거부
+        if (line.find('\n') != std::string_view::npos || line.find('\0') != std::string_view::npos) {
+            return HttpParseResult::Invalid;
+        }
+
+        std::string_view value = line.substr(1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+
+        if (request.headerCount == HttpRequest::MAX_HEADERS) {
+            return HttpParseResult::TooLarge;
+        }
+        request.headers[request.headerCount++] = { name, value };
+
+        if (httpEqualsNoCase(name, "connection")) {
+            // 쉼표로 구분된 옵션 중 close / keep-alive 를 찾음
+            while (!value.empty()) {
+                size_t comma = value.find(',');
+                std::string_view option = value.substr(0, comma);
+                while (!option.empty() && option.front() == ' ') option.remove_prefix(1);
+                while (!option.empty() && option.back() == ' ') option.remove_suffix(1);
+                if (httpEqualsNoCase(option, "close")) {
+                    request.keepAlive = false;
+                } else if (httpEqualsNoCase(option, "keep-alive")) {
+                    request.keepAlive = true;
+                }
+                value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+            }
+        } else if (httpEqualsNoCase(name, "content-length")) {
+            // 숫자만 허용, 서로 다른 Content-Length 가 두 번 오면 거부
+            if (value.empty() || value.size() > 10) {
+                return value.empty() ? HttpParseResult::Invalid : HttpParseResult::BodyTooLarge;
+            }
+            size_t contentLength = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') {
+                    return HttpParseResult::Invalid;
+                }
+                contentLength = contentLength * 10 + (c - '0');
+            }
+            if (hasContentLength && contentLength != request.contentLength) {
+                return HttpParseResult::Invalid;
+            }
+            if (contentLength > MAX_BODY_SIZE) {
+                return HttpParseResult::BodyTooLarge;
+            }
+            request.contentLength = contentLength;
+            hasContentLength = true;
+        } else if (httpEqualsNoCase(name, "transfer-encoding")) {
+            // chunked 본문은 지원하지 않음 (Content-Length 와 섞이면 요청 경계가 어긋날 수 있으므로 거부)
+            return HttpParseResult::Invalid;
+        }
+    }
+
+    return HttpParseResult::Complete;
+}
@@ -0,0 +1,109 @@
+// MemoryPool (스레드 캐시 + lock-free 전역 스택) 와 예전 뮤텍스 방식 풀, new/delete 의 멀티스레드 할당/해제 속도 비교
+// 빌드 예: cl /O2 /std:c++17 /EHsc MemoryPoolBench.cpp
+#include "lib.h"
+#include <chrono>
+
+// 예전 lib.h 의 MemoryPool: 모든 alloc/dealloc 이 하나의 뮤텍스를 잡음
+class MutexMemoryPool {
+    size_t blockSize;
+    vector<char*> freeBlocks;
+    mutex mtx;
+
+public:
+    explicit MutexMemoryPool(size_t blockSize, size_t reserve = 0) : blockSize(blockSize) {
+        freeBlocks.reserve(reserve);
+        for (size_t i = 0; i < reserve; i++) {
+            freeBlocks.push_back(new char[blockSize]);
+        }
+    }
+
+    ~MutexMemoryPool() {
+        for (char* block : freeBlocks) {
+            delete[] block;
+        }
+    }
+
+    void* alloc() {
+        lock_guard<mutex> lock(mtx);
+        if (freeBlocks.empty()) {
+            return new char[blockSize];
+        }
+        char* block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return block;
+    }
+
+    void dealloc(void* ptr) {
+        lock_guard<mutex> lock(mtx);
+        freeBlocks.push_back(static_cast<char*>(ptr));
+    }
+};
+
+constexpr size_t BLOCK_SIZE = 1024;
+constexpr int ROUNDS = 50000; // 스레드마다 반복 횟수
+constexpr int LIVE_BLOCKS = 100; // 한 번에 들고 있는 블록 수 (스레드 캐시보다 많아서 전역 스택과 묶음을 주고받게 됨)
+
+// 스레드마다 블록 LIVE_BLOCKS 개를 할당했다가 모두 해제하는 것을 반복, 초당 alloc+dealloc 쌍 수를 출력
+template <typename Alloc, typename Free>
+void run(const char* name, int threadCount, Alloc&& allocBlock, Free&& freeBlock) {
+    atomic<int> ready{ 0 };
+    atomic<bool> go{ false };
+    vector<thread> threads;
+
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&] {
+            void* blocks[LIVE_BLOCKS];
+            ready++;
+            while (!go) {
+                this_thread::yield();
+            }
+            for (int round = 0; round < ROUNDS; round++) {
+                for (int i = 0; i < LIVE_BLOCKS; i++) {
+                    blocks[i] = allocBlock();
+                    static_cast<char*>(blocks[i])[0] = static_cast<char>(i); // 블록을 실제로 건드림
+                }
+                for (int i = 0; i < LIVE_BLOCKS; i++) {
+                    freeBlock(blocks[i]);
+                }
+            }
+        });
+    }
+
+    while (ready != threadCount) {
+        this_thread::yield();
+    }
+    auto start = chrono::steady_clock::now();
+    go = true;
+    for (thread& t : threads) {
+        t.join();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double seconds = chrono::duration<double>(end - start).count();
+    double pairs = static_cast<double>(threadCount) * ROUNDS * LIVE_BLOCKS;
+    cout << "  " << name << ": " << (pairs / seconds / 1e6) << " M alloc+free/s" << endl;
+}
+
+int main() {
+    cout << "block size: " << BLOCK_SIZE << " bytes, " << ROUNDS << " rounds x " << LIVE_BLOCKS << " blocks per thread" << endl;
+
+    for (int threadCount : { 1, 4, 16 }) {
+        cout << threadCount << " thread(s)" << endl;
+
+        MutexMemoryPool mutexPool(BLOCK_SIZE, 1024);
+        run("mutex pool", threadCount,
+            [&] { return mutexPool.alloc(); },
+            [&](void* ptr) { mutexPool.dealloc(ptr); });
+
+        MemoryPool pool(BLOCK_SIZE, 1024);
+        run("MemoryPool", threadCount,
+            [&] { return pool.alloc(); },
+            [&](void* ptr) { pool.dealloc(ptr); });
+
+        run("new/delete", threadCount,
+            [] { return static_cast<void*>(new char[BLOCK_SIZE]); },
+            [](void* ptr) { delete[] static_cast<char*>(ptr); });
+    }
+
+    return 0;
+}
@@ -1,76 +1,824 @@
-#include <iostream>
-#include <WinSock2.h>
-#include <Windows.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "ws2_32.lib") 
+#include "lib.h"
 #include <string>
-#include <vector>
-#include <mutex>
-#include <unordered_map>
-#include <thread>
-#include <atomic>
-#include <memory>
+#include "EventLoop.h"
+#include "HttpParser.h"
+#include "Router.h"
+#include "RecvBuffer.h"
+#include "SendQueue.h"
+#include "TimerWheel.h"
 
 using namespace std;
 
-class MemoryPool {
-    size_t blockSize;
-    vector<char*> freeBlocks;
-    mutex mtx;
+// 스레드별 힙 할당 횟수 (스레드마다 따로 세므로 서로 방해하지 않음)
+// 세려면 전역 operator new 를 바꿔야 하므로 (CRT 와 STL 의 할당도 모두 바뀜), 요청 처리에 할당이 없는지 확인할 때만
+// COUNT_HEAP_ALLOCATIONS 를 정의하고 빌드함 (예: cl /O2 /std:c++17 /EHsc /DCOUNT_HEAP_ALLOCATIONS Ne1.cpp), 평소에는 세지 않고 할당자를 그대로 둠
+#ifdef COUNT_HEAP_ALLOCATIONS
+thread_local size_t heapAllocations = 0;
+
+void* countedAlloc(size_t size) noexcept {
+    heapAllocations++;
+    return malloc(size != 0 ? size : 1);
+}
+
+void* countedAlignedAlloc(size_t size, align_val_t align) noexcept {
+    heapAllocations++;
+    return _aligned_malloc(size != 0 ? size : 1, static_cast<size_t>(align));
+}
+
+// 배열, 정렬, nothrow 형태도 모두 바꿔서 빠짐없이 셈 (정렬 형태는 _aligned_malloc 으로 받았으므로 _aligned_free 로 돌려줌)
+void* operator new(size_t size) {
+    if (void* ptr = countedAlloc(size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(size_t size, align_val_t align) {
+    if (void* ptr = countedAlignedAlloc(size, align)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t align) {
+    return operator new(size, align);
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, const nothrow_t&) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const nothrow_t&) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, align_val_t) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete(void* ptr, align_val_t, const nothrow_t&) noexcept {
+    _aligned_free(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t, const nothrow_t&) noexcept {
+    _aligned_free(ptr);
+}
+#else
+constexpr size_t heapAllocations = 0;
+#endif
+
+// 동적 페이지의 본문을 만드는 함수 (body 는 연결의 Arena 에서 메모리를 받음)
+using PageHandler = void (*)(const HttpRequest& request, pmr::string& body);
+
+// 경로 하나에 대한 페이지
+struct Page {
+    const char* status;
+    string_view body;    // 정적 페이지 본문
+    PageHandler handler; // 동적 페이지면 본문을 만드는 함수 (정적 페이지는 nullptr)
+};
+
+void statusPage(const HttpRequest& request, pmr::string& body);
+
+// 경로 테이블 (컴파일 타임에 해시 테이블로 만들어져서 경로가 늘어나도 한 번에 찾음)
+constexpr Route<Page> ROUTES[] = {
+    { "/", { "200 OK",
+        "<h1>Welcome to Dragon Ball Homepage</h1>"
+        "<a href=\"/Goku\">Visit Goku</a><br>"
+        "<a href=\"/Vegeta\">Visit Vegeta</a><br>"
+        "<a href=\"/Gohan\">Visit Gohan</a><br>"
+        "<a href=\"/Piccolo\">Visit Piccolo</a><br>", nullptr } },
+    { "/Goku", { "200 OK", "<h1>Welcome to Goku's Profile</h1><p>Goku is the main protagonist of the Dragon Ball series.</p><a href=\"/\">Back to Home</a>", nullptr } },
+    { "/Vegeta", { "200 OK", "<h1>Welcome to Vegeta's Profile</h1><p>Vegeta is a Saiyan prince and one of the most powerful characters in Dragon Ball.</p><a href=\"/\">Back to Home</a>", nullptr } },
+    { "/Gohan", { "200 OK", "<h1>Welcome to Gohan's Profile</h1><p>Gohan is the eldest son of Goku and one of the main characters in Dragon Ball.</p><a href=\"/\">Back to Home</a>", nullptr } },
+    { "/Piccolo", { "200 OK", "<h1>Welcome to Piccolo's Profile</h1><p>Piccolo is a Namekian warrior and one of Goku's allies.</p><a href=\"/\">Back to Home</a>", nullptr } },
+    { "/status", { "200 OK", "", statusPage } },
+};
+constexpr auto ROUTE_TABLE = makeRouteTable(ROUTES);
+constexpr Page NOT_FOUND_PAGE = { "404 Not Found", "<h1>404 Not Found</h1>", nullptr };
+
+// 워커 스레드 최대 개수
+constexpr size_t MAX_WORKERS = 64;
+
+// 워커별 서버 상태 (/status 페이지에서 합쳐서 보여줌)
+// 워커마다 자기 것만 고치고, 서로 다른 캐시 라인에 놓아서 워커끼리 공유하는 쓰기가 없도록 함
+struct alignas(64) ServerStats {
+    atomic<size_t> openConnections{ 0 };
+    atomic<size_t> requestsServed{ 0 };
+    atomic<size_t> heapAllocations{ 0 }; // 워커가 시작한 뒤로 힙 할당 횟수 (COUNT_HEAP_ALLOCATIONS 로 빌드했을 때만 셈)
+    atomic<size_t> socketCalls{ 0 };     // 워커가 시작한 뒤로 부른 소켓/대기 함수 횟수 (I/O 방식끼리 비교용)
+};
+ServerStats workerStats[MAX_WORKERS];
+
+void statusPage(const HttpRequest&, pmr::string& body) {
+    size_t openConnections = 0, requestsServed = 0, allocations = 0, socketCalls = 0;
+    for (const ServerStats& stats : workerStats) {
+        openConnections += stats.openConnections.load(memory_order_relaxed);
+        requestsServed += stats.requestsServed.load(memory_order_relaxed);
+        allocations += stats.heapAllocations.load(memory_order_relaxed);
+        socketCalls += stats.socketCalls.load(memory_order_relaxed);
+    }
+
+    // 짧은 숫자는 to_string 결과가 string 내부 버퍼에 들어가므로 힙 할당 없이 이어 붙임
+    body = "<h1>Server Status</h1>";
+    body += "<p>Open connections: ";
+    body += to_string(openConnections);
+    body += "</p><p>Requests served: ";
+    body += to_string(requestsServed);
+#ifdef COUNT_HEAP_ALLOCATIONS
+    body += "</p><p>Heap allocations: ";
+    body += to_string(allocations);
+#else
+    (void)allocations;
+    body += "</p><p>Heap allocations: not counted (build with COUNT_HEAP_ALLOCATIONS)";
+#endif
+    body += "</p><p>Socket calls: ";
+    body += to_string(socketCalls);
+    body += "</p>";
+}
+
+// 요청마다 로그를 남길지 (모든 워커가 cout 하나를 같이 쓰므로 켜면 느려짐)
+constexpr bool LOG_REQUESTS = false;
+
+// 상태 줄부터 Content-Length 까지의 응답 헤더 (Connection 헤더는 요청마다 따로 붙임)
+template <typename String>
+void makeHeader(String& header, const char* status, size_t contentLength) {
+    header = "HTTP/1.1 ";
+    header += status;
+    header += "\r\nContent-Type: text/html\r\nContent-Length: ";
+    header += to_string(contentLength);
+    header += "\r\n";
+}
+
+// 연결이 무엇을 기다리는 중인지 (단계마다 제한 시간이 다름)
+enum class ConnectionPhase {
+    Reading, // 요청이 다 오기를 기다림 (요청이 시작된 때부터 잼)
+    Sending, // 응답을 받아 가기를 기다림 (조금이라도 받아 가면 다시 잼)
+    Idle,    // 다음 요청을 기다림 (keep-alive)
+};
+
+// 연결 하나의 상태 (keep-alive 로 여러 요청을 주고받는 동안 유지됨)
+struct Connection {
+    // 아직 처리하지 않은 수신 데이터 (파이프라이닝된 요청이 여러 개 들어있을 수 있음, 가장 큰 요청 하나까지 늘어남)
+    RecvBuffer buffer{ HttpParser::MAX_HEADER_SIZE + HttpParser::MAX_BODY_SIZE };
+    TimerWheel::Timer timer;     // 지금 단계의 제한 시간 (지나면 연결을 닫음)
+    ConnectionPhase phase = ConnectionPhase::Idle;
+    HttpParser parser;           // buffer 맨 앞 요청을 어디까지 확인했는지 기억
+    Arena arena;                 // 요청 하나를 처리하는 동안 쓰는 임시 메모리 (응답을 만들면 한꺼번에 되돌림)
+    SendQueue sendQueue;         // 아직 보내지 못한 응답
+    uint32_t events = IO_READ;   // 이벤트 루프에 등록한 관심 이벤트
+    bool closeAfterSend = false; // 남은 응답을 다 보내면 연결을 닫음 (Connection: close, 잘못된 요청)
+};
+
+// 두 I/O 방식의 워커가 같이 쓰는 요청 처리 (파싱, 경로 찾기, 응답을 송신 대기열에 쌓기)
+// 소켓에서 읽고 쓰는 방법만 워커마다 다르고, 받은 데이터로 응답을 만드는 과정은 여기 하나뿐이다
+class RequestHandler {
+protected:
+    const vector<PoolString>& pageHeaders; // 정적 페이지마다 미리 만들어 둔 응답 헤더 (읽기 전용)
+    ServerStats& stats;
+    size_t sendHighWaterMark; // 보내지 못한 응답이 이만큼 쌓이면 그 연결에서는 더 읽지 않음
+    size_t socketCalls;       // 워커가 부른 소켓/대기 함수 횟수 (stats 에는 루프마다 한 번씩 옮김)
+    TimerWheel timers;        // 연결마다의 제한 시간 (워커의 대기 timeout 도 다음 만료 시각에 맞춤)
+
+    // 요청 하나가 시작된 뒤 이 시간 안에 다 오지 않으면 연결을 닫음 (조금씩 보내서 연결을 붙잡는 클라이언트 방지)
+    static constexpr ULONGLONG READ_TIMEOUT_MS = 5000;
+    // 보내지 못한 응답이 이 시간 동안 조금도 빠지지 않으면 연결을 닫음
+    static constexpr ULONGLONG SEND_TIMEOUT_MS = 5000;
+    // 이 시간 동안 요청이 없는 keep-alive 연결은 닫음
+    static constexpr ULONGLONG KEEP_ALIVE_TIMEOUT_MS = 5000;
+
+    RequestHandler(const vector<PoolString>& pageHeaders, ServerStats& stats, size_t sendHighWaterMark)
+        : pageHeaders(pageHeaders), stats(stats), sendHighWaterMark(sendHighWaterMark), socketCalls(0), timers(GetTickCount64()) {}
+
+    // 연결의 지금 단계에 맞는 제한 시간을 검
+    // 단계가 바뀌었거나 진척이 있었을 때만 (요청을 처리했거나 응답을 조금이라도 보냄) 다시 걸어서 조금씩만 보내는 클라이언트는 연장되지 않음
+    // timerKey 는 만료될 때 연결을 다시 찾는 데 쓰는 값 (워커마다 연결을 찾는 키)
+    void updateTimer(uintptr_t timerKey, Connection& connection, bool progressed) {
+        ConnectionPhase phase = !connection.sendQueue.empty() ? ConnectionPhase::Sending
+            : connection.buffer.size() > 0 ? ConnectionPhase::Reading : ConnectionPhase::Idle;
+        if (phase == connection.phase && !progressed && connection.timer.scheduled()) {
+            return;
+        }
+
+        ULONGLONG timeout = phase == ConnectionPhase::Reading ? READ_TIMEOUT_MS
+            : phase == ConnectionPhase::Sending ? SEND_TIMEOUT_MS : KEEP_ALIVE_TIMEOUT_MS;
+        connection.phase = phase;
+        connection.timer.key = timerKey;
+        timers.schedule(connection.timer, GetTickCount64() + timeout);
+    }
+
+    // 버퍼에 완성된 요청이 있는 동안 차례대로 응답을 쌓고 (파이프라이닝), 처리한 요청 수를 반환
+    // 덜 온 요청은 다음 수신까지 남겨두고, 보내지 못한 응답이 sendHighWaterMark 를 넘으면 거기서 멈춤
+    size_t serveBuffered(SOCKET clientSocket, Connection& connection) {
+        HttpRequest request;
+        size_t served = 0;
+        while (!connection.closeAfterSend && connection.sendQueue.pendingBytes() < sendHighWaterMark) {
+            size_t used = 0;
+            HttpParseResult result = connection.parser.parse(connection.buffer.data(), connection.buffer.size(), request, used);
+            if (result == HttpParseResult::Incomplete) {
+                break;
+            }
+            if (result != HttpParseResult::Complete) {
+                // 잘못된 요청은 에러를 알리고 연결을 끊음 (이후 데이터는 요청 경계를 알 수 없음)
+                sendError(connection, httpErrorStatus(result));
+                break;
+            }
+
+            bool keepAlive = respond(clientSocket, connection, request);
+            connection.arena.reset(); // 응답을 송신 대기열에 넣었으므로 이 요청이 쓴 임시 메모리를 되돌림
+            connection.buffer.consume(used); // request 가 가리키던 데이터도 이제 필요 없음
+            served++;
+            if (!keepAlive) {
+                connection.closeAfterSend = true;
+            }
+        }
+        return served;
+    }
+
+    // 에러 응답을 쌓고, 다 보내면 연결을 닫도록 표시
+    void sendError(Connection& connection, const char* status) {
+        pmr::string response("HTTP/1.1 ", &connection.arena);
+        response += status;
+        response += "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+        connection.sendQueue.pushCopy(response.data(), response.size());
+        connection.closeAfterSend = true;
+    }
+
+    // 요청 하나의 응답을 송신 대기열에 넣고, 연결을 계속 유지할지 반환
+    bool respond(SOCKET clientSocket, Connection& connection, const HttpRequest& request) {
+        if (LOG_REQUESTS) {
+            cout << "Received request from client " << clientSocket << ": " << request.method << " " << request.path << endl;
+        }
+
+        stats.requestsServed.fetch_add(1, memory_order_relaxed);
+
+        // 경로 테이블에서 한 번에 찾음 (GET 이 아니거나 없는 경로면 404)
+        int index = request.method == "GET" ? ROUTE_TABLE.find(request.path) : -1;
+        const Page& page = index >= 0 ? ROUTE_TABLE[index].target : NOT_FOUND_PAGE;
+
+        // 정적 페이지는 미리 만들어 둔 헤더와 본문을 그대로 보내고, 동적 페이지만 본문과 헤더를 만든다
+        string_view header = pageHeaders[index >= 0 ? index : ROUTE_TABLE.size()];
+        string_view body = page.body;
+        pmr::string dynamicHeader(&connection.arena), dynamicBody(&connection.arena);
+        if (page.handler != nullptr) {
+            page.handler(request, dynamicBody);
+            makeHeader(dynamicHeader, page.status, dynamicBody.size());
+            header = dynamicHeader;
+            body = dynamicBody;
+        }
+
+        // 정적 페이지의 헤더와 본문은 서버가 끝날 때까지 남아 있으므로 복사하지 않고 가리키기만 함
+        SendQueue& queue = connection.sendQueue;
+        string_view connectionHeader = httpConnectionHeader(request.keepAlive);
+        if (page.handler != nullptr) {
+            queue.pushCopy(header.data(), header.size());
+        } else {
+            queue.pushRef(header.data(), header.size());
+        }
+        queue.pushRef(connectionHeader.data(), connectionHeader.size());
+        if (page.handler != nullptr) {
+            queue.pushCopy(body.data(), body.size());
+        } else {
+            queue.pushRef(body.data(), body.size());
+        }
+        return request.keepAlive;
+    }
+};
+
+// 준비 상태 방식 워커: 자기 이벤트 루프와 클라이언트 목록을 가지고 다른 워커와 아무것도 공유하지 않음
+// 리슨 소켓만 모든 워커가 같이 감시하고, 먼저 깨어난 워커가 연결을 가져감
+class Worker : RequestHandler {
+    SOCKET serverSocket;
+    const atomic<bool>& isRunning;
+    // 노드도 풀에서 할당 (연결이 생기고 끊길 때마다 힙을 쓰지 않도록)
+    unordered_map<SOCKET, Connection, hash<SOCKET>, equal_to<SOCKET>, PoolAllocator<pair<const SOCKET, Connection>>> clients;
+    unique_ptr<EventLoop> eventLoop;
+    size_t startAllocations; // 워커가 시작할 때의 heapAllocations (시작할 때 만든 것은 빼고 셈)
+
+    // stop() 이 호출되었는지 확인하기 위해 대기 중에도 이 간격마다 한 번씩 깨어남
+    static constexpr int WAIT_TIMEOUT_MS = 1000;
+    // 한 번 깨어났을 때 수락할 최대 연결 수 (한 워커가 연결을 몰아서 가져가지 않도록)
+    static constexpr int ACCEPT_BATCH = 4;
 
 public:
-    explicit MemoryPool(size_t blockSize, size_t reserve = 0) : blockSize(blockSize) {
-        freeBlocks.reserve(reserve);
-        for (size_t i = 0; i < reserve; i++) {
-            freeBlocks.push_back(new char[blockSize]);
+    Worker(SOCKET serverSocket, const vector<PoolString>& pageHeaders, ServerStats& stats, const atomic<bool>& isRunning, size_t sendHighWaterMark)
+        : RequestHandler(pageHeaders, stats, sendHighWaterMark), serverSocket(serverSocket), isRunning(isRunning),
+          eventLoop(createEventLoop()), startAllocations(0) {}
+
+    ~Worker() {
+        for (const auto& [clientSocket, connection] : clients) {
+            closesocket(clientSocket);
         }
     }
 
-    ~MemoryPool() {
-        for (char* block : freeBlocks) {
-            delete[] block;
+    void run() {
+        if (!eventLoop->add(serverSocket, IO_READ)) {
+            cerr << "Error registering listen socket" << endl;
+            return;
+        }
+
+        vector<IoReady> ready;
+        startAllocations = heapAllocations;
+        while (isRunning) {
+            // 준비된 소켓이 생기거나 가장 가까운 제한 시간이 될 때까지 잠들어 있다가 해당 소켓만 처리
+            socketCalls++;
+            if (eventLoop->wait(ready, timers.timeoutMs(GetTickCount64(), WAIT_TIMEOUT_MS)) < 0) {
+                cerr << "Error waiting for socket events" << endl;
+                break;
+            }
+
+            for (const IoReady& event : ready) {
+                if (event.socket == serverSocket) {
+                    acceptClients();
+                } else if (event.events & IO_ERROR) {
+                    cerr << "Socket error on client " << event.socket << endl;
+                    closeClient(event.socket);
+                } else {
+                    // 송신 버퍼에 자리가 생겼으면 남은 응답부터 보내고, 그다음 새로 들어온 데이터를 읽음
+                    if (event.events & IO_WRITE) {
+                        handleWrite(event.socket);
+                    }
+                    if ((event.events & IO_READ) && clients.count(event.socket)) {
+                        handleRequest(event.socket);
+                    }
+                }
+            }
+
+            // 제한 시간이 지난 연결을 닫음
+            timers.advance(GetTickCount64(), [this](TimerWheel::Timer& timer) {
+                if (LOG_REQUESTS) {
+                    cout << "Closing timed out client: " << timer.key << endl;
+                }
+                closeClient(static_cast<SOCKET>(timer.key));
+            });
+            stats.heapAllocations.store(heapAllocations - startAllocations, memory_order_relaxed);
+            stats.socketCalls.store(socketCalls, memory_order_relaxed);
         }
     }
 
-    void* alloc() {
-        lock_guard<mutex> lock(mtx);
-        void* block;
+private:
+    // 리슨 소켓이 준비되면 대기 중인 연결을 수락 (다른 워커가 먼저 가져갔으면 WSAEWOULDBLOCK)
+    void acceptClients() {
+        for (int i = 0; i < ACCEPT_BATCH; i++) {
+            SOCKADDR_IN clientAddr;
+            int clientAddrLen = sizeof(clientAddr);
+            socketCalls++;
+            SOCKET clientSocket = accept(serverSocket, reinterpret_cast<SOCKADDR*>(&clientAddr), &clientAddrLen);
+            if (clientSocket == INVALID_SOCKET) {
+                if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                    cerr << "Error accepting client" << endl;
+                }
+                return;
+            }
 
-        if (!freeBlocks.empty()) {
-            block = freeBlocks.back();
-            freeBlocks.pop_back();
+            if (LOG_REQUESTS) {
+                cout << "Client connected" << endl;
+            }
+            u_long on = 1;
+            if (ioctlsocket(clientSocket, FIONBIO, &on) == SOCKET_ERROR || !eventLoop->add(clientSocket, IO_READ)) {
+                cerr << "Error setting non-blocking mode for client socket" << endl;
+                closesocket(clientSocket);
+            } else {
+                stats.openConnections.fetch_add(1, memory_order_relaxed);
+                Connection& connection = clients.try_emplace(clientSocket).first->second;
+                updateTimer(clientSocket, connection, true);
+            }
         }
-        else {
-            block = new char[blockSize];
+    }
+
+    void closeClient(SOCKET clientSocket) {
+        auto it = clients.find(clientSocket);
+        if (it == clients.end()) {
+            return;
         }
 
-        return block;
+        stats.openConnections.fetch_sub(1, memory_order_relaxed);
+        timers.cancel(it->second.timer);
+        eventLoop->remove(clientSocket);
+        closesocket(clientSocket);
+        clients.erase(it);
     }
 
-    void dealloc(void* ptr) {
-        lock_guard<mutex> lock(mtx);
-        if (ptr != nullptr) {
-            freeBlocks.push_back(reinterpret_cast<char*>(ptr));
+    // 읽을 데이터가 있는 클라이언트 하나만 처리
+    void handleRequest(SOCKET clientSocket) {
+        Connection& connection = clients[clientSocket];
+
+        // 연결의 수신 버퍼 빈 자리에 바로 받음
+        size_t space = 0;
+        char* dest = connection.buffer.prepare(space);
+        if (dest == nullptr) {
+            sendError(connection, httpErrorStatus(HttpParseResult::TooLarge));
+            flushClient(clientSocket, connection, false);
+            return;
+        }
+
+        socketCalls++;
+        int bytesRead = recv(clientSocket, dest, static_cast<int>(space), 0);
+        if (bytesRead == 0) {
+            if (LOG_REQUESTS) {
+                cout << "Client disconnected: " << clientSocket << endl;
+            }
+            closeClient(clientSocket);
+            return;
         }
+        if (bytesRead < 0) {
+            if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                cerr << "Error in recv from client " << clientSocket << endl;
+                closeClient(clientSocket);
+            }
+            return;
+        }
+
+        connection.buffer.commit(bytesRead);
+        serveRequests(clientSocket, connection);
     }
 
-    void resize(size_t addreserve) {
-        lock_guard<mutex> lock(mtx);
-        freeBlocks.reserve(freeBlocks.capacity() + addreserve);
-        for (size_t i = 0; i < addreserve; i++) {
-            freeBlocks.push_back(new char[blockSize]);
+    // 쓰기 가능해진 클라이언트에게 남은 응답을 보냄
+    void handleWrite(SOCKET clientSocket) {
+        Connection& connection = clients[clientSocket];
+        // 송신이 밀려서 읽기를 멈췄던 동안 버퍼에 남은 요청도 이어서 처리
+        serveRequests(clientSocket, connection);
+    }
+
+    // 버퍼에 완성된 요청의 응답을 쌓고, 쌓인 응답을 보냄
+    void serveRequests(SOCKET clientSocket, Connection& connection) {
+        bool served = serveBuffered(clientSocket, connection) > 0;
+        flushClient(clientSocket, connection, served);
+    }
+
+    // 쌓인 응답을 보낼 수 있는 만큼 보내고, 남은 양에 따라 관심 이벤트와 제한 시간을 바꿈
+    void flushClient(SOCKET clientSocket, Connection& connection, bool served) {
+        size_t pending = connection.sendQueue.pendingBytes();
+        socketCalls++;
+        SendQueue::FlushResult result = connection.sendQueue.flush(clientSocket);
+        if (result == SendQueue::FlushResult::Error) {
+            cerr << "Error sending response to client " << clientSocket << endl;
+            closeClient(clientSocket);
+            return;
+        }
+        if (result == SendQueue::FlushResult::Done && connection.closeAfterSend) {
+            closeClient(clientSocket);
+            return;
         }
+
+        // 남은 응답이 있으면 쓰기 가능해질 때 알림을 받고, 너무 많이 쌓였거나 닫을 연결이면 읽기를 멈춤 (backpressure)
+        uint32_t events = 0;
+        if (!connection.closeAfterSend && connection.sendQueue.pendingBytes() < sendHighWaterMark) {
+            events |= IO_READ;
+        }
+        if (!connection.sendQueue.empty()) {
+            events |= IO_WRITE;
+        }
+        if (events != connection.events) {
+            eventLoop->modify(clientSocket, events);
+            connection.events = events;
+        }
+        updateTimer(clientSocket, connection, served || connection.sendQueue.pendingBytes() < pending);
     }
 };
 
+// 완료 통지 방식 워커: 수신/송신을 overlapped 로 걸어 두고 I/O completion port 에서 끝난 것만 받아 처리
+// 준비 상태를 물어본 뒤 다시 recv/send 를 부르는 대신 커널이 버퍼에 직접 받고 보낸 결과를 한 번에 돌려주므로,
+// 요청 하나에 드는 시스템 호출이 줄어든다 (GetQueuedCompletionStatusEx 한 번으로 여러 완료를 꺼냄)
+// 연결마다 수신이나 송신 중 하나만 걸어 두므로 한 연결의 상태를 두 곳에서 동시에 건드리지 않는다
+// 연결은 수락 스레드가 넘겨주며, 넘겨받은 뒤로는 이 워커만 그 연결을 다룸
+// 세션은 소켓 값이 아니라 연결마다 새로 붙이는 번호로 찾음: 닫은 소켓의 값은 Windows 가 새 소켓에 다시 쓰므로,
+// 소켓 값으로 찾으면 취소 완료를 기다리는 옛 세션과 새 연결이 섞일 수 있음 (번호는 완료 키로도 씀)
+class CompletionWorker : RequestHandler {
+    // 연결 하나의 상태 + 걸어 둔 I/O
+    struct Session : Connection {
+        SOCKET socket = INVALID_SOCKET;
+        uintptr_t id = 0;           // clients 의 키이자 완료 키
+        OVERLAPPED overlapped{};
+        bool sending = false;       // 걸어 둔 I/O 가 송신이면 true, 수신이면 false
+        bool closed = false;        // 소켓을 닫았고 걸어 둔 I/O 의 취소 완료만 기다리는 중
+        bool skipOnSuccess = false; // 바로 끝난 I/O 는 완료 포트에 알리지 않음 (그 자리에서 이어서 처리)
+    };
+
+    // I/O 를 건 결과
+    enum class IoStart {
+        Pending,   // 완료 포트로 결과가 옴
+        Completed, // 바로 끝남 (완료 포트로 알림이 오지 않으므로 바로 처리)
+        Failed,
+    };
+
+    HANDLE port;
+    const atomic<bool>& isRunning;
+    unordered_map<uintptr_t, Session, hash<uintptr_t>, equal_to<uintptr_t>, PoolAllocator<pair<const uintptr_t, Session>>> clients; // 연결 번호 → 세션
+    uintptr_t nextSessionId = 1;
+    size_t startAllocations;
+
+    // stop() 이 호출되었는지 확인하기 위해 대기 중에도 이 간격마다 한 번씩 깨어남
+    static constexpr int WAIT_TIMEOUT_MS = 1000;
+    // GetQueuedCompletionStatusEx 한 번에 꺼낼 최대 완료 수
+    static constexpr ULONG MAX_COMPLETIONS = 64;
+
+public:
+    CompletionWorker(const vector<PoolString>& pageHeaders, ServerStats& stats, const atomic<bool>& isRunning, size_t sendHighWaterMark)
+        : RequestHandler(pageHeaders, stats, sendHighWaterMark), isRunning(isRunning), startAllocations(0) {
+        port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+    }
+
+    ~CompletionWorker() {
+        CloseHandle(port);
+    }
+
+    CompletionWorker(const CompletionWorker&) = delete;
+    CompletionWorker& operator=(const CompletionWorker&) = delete;
+
+    bool isValid() const {
+        return port != NULL;
+    }
+
+    // 수락한 연결을 이 워커에게 넘김 (다른 스레드에서 호출, overlapped 가 nullptr 이고 키가 소켓인 완료로 전달됨)
+    bool handOff(SOCKET clientSocket) {
+        return PostQueuedCompletionStatus(port, 0, static_cast<ULONG_PTR>(clientSocket), nullptr) != FALSE;
+    }
+
+    void run() {
+        OVERLAPPED_ENTRY entries[MAX_COMPLETIONS];
+        startAllocations = heapAllocations;
+        while (isRunning) {
+            ULONG count = 0;
+            DWORD timeout = static_cast<DWORD>(timers.timeoutMs(GetTickCount64(), WAIT_TIMEOUT_MS));
+            socketCalls++;
+            if (!GetQueuedCompletionStatusEx(port, entries, MAX_COMPLETIONS, &count, timeout, FALSE)) {
+                if (GetLastError() != WAIT_TIMEOUT) {
+                    cerr << "Error waiting for completions" << endl;
+                    break;
+                }
+                count = 0;
+            }
+
+            for (ULONG i = 0; i < count; i++) {
+                handleCompletion(entries[i]);
+            }
+
+            // 제한 시간이 지난 연결을 닫음 (걸어 둔 I/O 가 취소되어 완료로 돌아오면 그때 정리)
+            timers.advance(GetTickCount64(), [this](TimerWheel::Timer& timer) {
+                if (LOG_REQUESTS) {
+                    cout << "Closing timed out client: " << timer.key << endl;
+                }
+                abortClient(clients.find(timer.key)->second);
+            });
+            stats.heapAllocations.store(heapAllocations - startAllocations, memory_order_relaxed);
+            stats.socketCalls.store(socketCalls, memory_order_relaxed);
+        }
+
+        // 걸어 둔 I/O 가 세션의 버퍼를 쓰지 않도록 모두 닫고, 취소 완료가 올 때까지 기다린 뒤 세션을 지움
+        for (auto& [sessionId, session] : clients) {
+            abortClient(session);
+        }
+        while (!clients.empty()) {
+            ULONG count = 0;
+            if (!GetQueuedCompletionStatusEx(port, entries, MAX_COMPLETIONS, &count, WAIT_TIMEOUT_MS, FALSE)) {
+                break;
+            }
+            for (ULONG i = 0; i < count; i++) {
+                handleCompletion(entries[i]);
+            }
+        }
+    }
+
+private:
+    void handleCompletion(const OVERLAPPED_ENTRY& entry) {
+        if (entry.lpOverlapped == nullptr) {
+            addClient(static_cast<SOCKET>(entry.lpCompletionKey));
+            return;
+        }
+
+        auto it = clients.find(entry.lpCompletionKey);
+        if (it == clients.end()) {
+            return;
+        }
+        Session& session = it->second;
+
+        // Internal 에는 I/O 의 상태 코드가 들어 있음 (0 이면 성공)
+        if (session.closed || entry.lpOverlapped->Internal != 0) {
+            closeClient(session);
+            return;
+        }
+        proceed(session, entry.dwNumberOfBytesTransferred);
+    }
+
+    void addClient(SOCKET clientSocket) {
+        uintptr_t sessionId = nextSessionId++;
+        if (!isRunning || CreateIoCompletionPort(reinterpret_cast<HANDLE>(clientSocket), port, static_cast<ULONG_PTR>(sessionId), 0) == NULL) {
+            closesocket(clientSocket);
+            return;
+        }
+
+        if (LOG_REQUESTS) {
+            cout << "Client connected" << endl;
+        }
+        stats.openConnections.fetch_add(1, memory_order_relaxed);
+        Session& session = clients.try_emplace(sessionId).first->second;
+        session.socket = clientSocket;
+        session.id = sessionId;
+        updateTimer(sessionId, session, true);
+        socketCalls++;
+        session.skipOnSuccess = SetFileCompletionNotificationModes(reinterpret_cast<HANDLE>(clientSocket), FILE_SKIP_COMPLETION_PORT_ON_SUCCESS) != FALSE;
+
+        DWORD bytes = 0;
+        switch (startRecv(session, bytes)) {
+        case IoStart::Pending:
+            break;
+        case IoStart::Completed:
+            proceed(session, bytes);
+            break;
+        case IoStart::Failed:
+            closeClient(session);
+            break;
+        }
+    }
+
+    // 끝난 I/O 의 결과를 반영하고 다음 I/O 를 검
+    // 보낼 응답이 있으면 송신, 없으면 버퍼의 요청을 처리해서 응답을 만들거나 다음 요청을 수신
+    // Connection: close 인 연결은 마지막 송신이 끝나면 닫음 (송신과 닫기를 이어서 처리)
+    void proceed(Session& session, DWORD bytes) {
+        while (true) {
+            if (session.sending) {
+                session.sendQueue.consume(bytes);
+            } else if (bytes == 0) {
+                if (LOG_REQUESTS) {
+                    cout << "Client disconnected: " << session.socket << endl;
+                }
+                closeClient(session);
+                return;
+            } else {
+                session.buffer.commit(bytes);
+            }
+
+            bool progressed = session.sending && bytes > 0;
+            if (session.sendQueue.empty()) {
+                progressed |= serveBuffered(session.socket, session) > 0;
+            }
+            updateTimer(session.id, session, progressed);
+
+            // 바로 끝난 I/O 는 전송량을 bytes 에 받아서 루프를 한 번 더 돎
+            IoStart result;
+            if (!session.sendQueue.empty()) {
+                result = startSend(session, bytes);
+            } else if (session.closeAfterSend) {
+                closeClient(session);
+                return;
+            } else {
+                result = startRecv(session, bytes);
+            }
+
+            if (result == IoStart::Pending) {
+                return;
+            }
+            if (result == IoStart::Failed) {
+                closeClient(session);
+                return;
+            }
+        }
+    }
+
+    // 수신 버퍼 빈 자리에 overlapped 수신을 검
+    IoStart startRecv(Session& session, DWORD& bytes) {
+        size_t space = 0;
+        char* dest = session.buffer.prepare(space);
+        if (dest == nullptr) {
+            sendError(session, httpErrorStatus(HttpParseResult::TooLarge));
+            return startSend(session, bytes);
+        }
+
+        WSABUF buf;
+        buf.buf = dest;
+        buf.len = static_cast<ULONG>(space);
+        DWORD flags = 0;
+        session.sending = false;
+        memset(&session.overlapped, 0, sizeof(session.overlapped));
+        return startIo(session, WSARecv(session.socket, &buf, 1, &bytes, &flags, &session.overlapped, NULL));
+    }
+
+    // 송신 대기열 앞쪽 조각들을 모아서 overlapped 송신을 검 (데이터는 완료될 때까지 대기열이 붙잡고 있음)
+    IoStart startSend(Session& session, DWORD& bytes) {
+        WSABUF bufs[SendQueue::MAX_GATHER];
+        size_t total = 0;
+        DWORD count = session.sendQueue.gather(bufs, total);
+        session.sending = true;
+        memset(&session.overlapped, 0, sizeof(session.overlapped));
+        return startIo(session, WSASend(session.socket, bufs, count, &bytes, 0, &session.overlapped, NULL));
+    }
+
+    // WSARecv/WSASend 의 반환값을 IoStart 로 바꿈
+    IoStart startIo(Session& session, int result) {
+        socketCalls++;
+        if (result == 0) {
+            // 완료 포트에도 알림이 가는 경우에는 그쪽에서 처리
+            return session.skipOnSuccess ? IoStart::Completed : IoStart::Pending;
+        }
+        return WSAGetLastError() == WSA_IO_PENDING ? IoStart::Pending : IoStart::Failed;
+    }
+
+    // 걸어 둔 I/O 가 없는 연결을 바로 정리
+    void closeClient(Session& session) {
+        if (!session.closed) {
+            closesocket(session.socket);
+        }
+        timers.cancel(session.timer);
+        stats.openConnections.fetch_sub(1, memory_order_relaxed);
+        clients.erase(session.id);
+    }
+
+    // I/O 가 걸려 있는 연결을 닫음 (취소된 I/O 의 완료가 오면 그때 세션을 지움)
+    // 소켓 값은 곧 다른 연결에 다시 쓰일 수 있지만, 세션은 자기 번호로만 찾으므로 새 연결과 섞이지 않음
+    void abortClient(Session& session) {
+        if (!session.closed) {
+            closesocket(session.socket);
+            session.closed = true;
+        }
+    }
+};
+
+// 워커가 소켓 I/O 를 하는 방식
+enum class IoEngine {
+    Readiness,  // 준비된 소켓을 WSAPoll 로 찾아서 recv/WSASend (Worker, 대기 한 번의 비용이 연결 수에 비례)
+    Completion, // overlapped I/O 를 걸어 두고 I/O completion port 로 결과를 받음 (CompletionWorker, 끝난 I/O 만 받으므로 연결 수와 무관)
+};
+
+// 리슨 소켓을 열고 워커 스레드 여러 개를 돌리는 서버
+// Windows 에는 SO_REUSEPORT 가 없으므로 워커마다 리슨 소켓을 따로 두는 대신 하나의 논블로킹 리슨 소켓을 모든 워커가 감시한다
+// Completion 방식에서는 리슨 소켓을 수락 스레드 하나가 감시하고, 수락한 연결을 워커들에게 돌아가며 넘긴다
 class WebServer {
     SOCKET serverSocket;
-    MemoryPool& memoryPool;
-    unordered_map<SOCKET, string> clients;
     atomic<bool> isRunning;
+    size_t workerCount;
+    IoEngine engine;
+    size_t sendHighWaterMark;
+    vector<PoolString> pageHeaders; // 정적 페이지마다 미리 만들어 둔 응답 헤더 (ROUTE_TABLE 순서, 마지막은 404)
+
+    // 한 번 깨어났을 때 수락할 최대 연결 수 (Completion 방식의 수락 스레드)
+    static constexpr int ACCEPT_BATCH = 64;
 
 public:
-    WebServer(MemoryPool& pool) : memoryPool(pool), isRunning(true) {}
+    // workerCount 가 0 이면 CPU 코어 수만큼 워커를 만듦
+    // sendHighWaterMark: 한 연결에 보내지 못한 응답이 이만큼 쌓이면 다 보낼 때까지 그 연결의 요청을 읽지 않음
+    WebServer(size_t workerCount = 0, IoEngine engine = IoEngine::Readiness, size_t sendHighWaterMark = 256 * 1024)
+        : serverSocket(INVALID_SOCKET), isRunning(true), engine(engine), sendHighWaterMark(sendHighWaterMark) {
+        if (workerCount == 0) {
+            workerCount = thread::hardware_concurrency();
+        }
+        this->workerCount = max<size_t>(1, min(workerCount, MAX_WORKERS));
+
+        pageHeaders.resize(ROUTE_TABLE.size() + 1);
+        for (size_t i = 0; i < ROUTE_TABLE.size(); i++) {
+            const Page& page = ROUTE_TABLE[i].target;
+            makeHeader(pageHeaders[i], page.status, page.body.size());
+        }
+        makeHeader(pageHeaders.back(), NOT_FOUND_PAGE.status, NOT_FOUND_PAGE.body.size());
+    }
 
     ~WebServer() {
         closesocket(serverSocket);
@@ -107,11 +855,31 @@ public:
             return;
         }
 
-        cout << "Server started on port " << port << endl;
+        u_long on = 1;
+        if (ioctlsocket(serverSocket, FIONBIO, &on) == SOCKET_ERROR) {
+            cerr << "Error setting non-blocking mode for listen socket" << endl;
+            closesocket(serverSocket);
+            WSACleanup();
+            return;
+        }
 
-        while (isRunning) {
-            acceptClient();
-            handleRequests();
+        cout << "Server started on port " << port << " with " << workerCount << " "
+             << (engine == IoEngine::Completion ? "completion" : "readiness") << " workers" << endl;
+
+        if (engine == IoEngine::Completion) {
+            runCompletionWorkers();
+            return;
+        }
+
+        vector<thread> workers;
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.emplace_back([this, i] {
+                Worker worker(serverSocket, pageHeaders, workerStats[i], isRunning, sendHighWaterMark);
+                worker.run();
+            });
+        }
+        for (thread& worker : workers) {
+            worker.join();
         }
     }
 
@@ -120,93 +888,57 @@ public:
     }
 
 private:
-    void acceptClient() {
-        SOCKADDR_IN clientAddr;
-        int clientAddrLen = sizeof(clientAddr);
-        SOCKET clientSocket = accept(serverSocket, reinterpret_cast<SOCKADDR*>(&clientAddr), &clientAddrLen);
-        if (clientSocket != INVALID_SOCKET) {
-            cout << "Client connected" << endl;
-            u_long on = 1;
-            if (ioctlsocket(clientSocket, FIONBIO, &on) == SOCKET_ERROR) {
-                cerr << "Error setting non-blocking mode for client socket" << endl;
-                closesocket(clientSocket);
-            } else {
-                clients[clientSocket] = "";
-            }
-        }
-    }
-
-    void handleRequests() {
-        char* buffer = static_cast<char*>(memoryPool.alloc());
-
-        for (auto it = clients.begin(); it != clients.end(); ) {
-            SOCKET clientSocket = it->first;
-            int bytesRead = recv(clientSocket, buffer, 1024, 0);
-
-            if (bytesRead > 0) {
-                buffer[bytesRead] = '\0';
-                cout << "Received request from client " << clientSocket << ": " << buffer << endl;
-
-                string request(buffer);
-
-                size_t startPos = request.find("GET ") + 4;
-                size_t endPos = request.find(" HTTP/");
-                string path = request.substr(startPos, endPos - startPos);
-
-                string response;
-                if (path == "/") {
-                    response = "HTTP/1.1 200 OK\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>Welcome to Dragon Ball Homepage</h1>";
-                    response += "<a href=\"/Goku\">Visit Goku</a><br>";
-                    response += "<a href=\"/Vegeta\">Visit Vegeta</a><br>";
-                    response += "<a href=\"/Gohan\">Visit Gohan</a><br>";
-                    response += "<a href=\"/Piccolo\">Visit Piccolo</a><br>";
-                } else if (path == "/Goku") {
-                    response = "HTTP/1.1 200 OK\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>Welcome to Goku's Profile</h1><p>Goku is the main protagonist of the Dragon Ball series.</p><a href=\"/\">Back to Home</a>";
-                } else if (path == "/Vegeta") {
-                    response = "HTTP/1.1 200 OK\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>Welcome to Vegeta's Profile</h1><p>Vegeta is a Saiyan prince and one of the most powerful characters in Dragon Ball.</p><a href=\"/\">Back to Home</a>";
-                } else if (path == "/Gohan") {
-                    response = "HTTP/1.1 200 OK\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>Welcome to Gohan's Profile</h1><p>Gohan is the eldest son of Goku and one of the main characters in Dragon Ball.</p><a href=\"/\">Back to Home</a>";
-                } else if (path == "/Piccolo") {
-                    response = "HTTP/1.1 200 OK\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>Welcome to Piccolo's Profile</h1><p>Piccolo is a Namekian warrior and one of Goku's allies.</p><a href=\"/\">Back to Home</a>";
-                } else {
-                    response = "HTTP/1.1 404 Not Found\r\n";
-                    response += "Content-Type: text/html\r\n\r\n";
-                    response += "<h1>404 Not Found</h1>";
+    // 워커마다 completion port 를 하나씩 두고, 이 스레드는 연결을 수락해서 돌아가며 넘겨주기만 함
+    void runCompletionWorkers() {
+        vector<unique_ptr<CompletionWorker>> workers;
+        for (size_t i = 0; i < workerCount; i++) {
+            workers.push_back(make_unique<CompletionWorker>(pageHeaders, workerStats[i], isRunning, sendHighWaterMark));
+            if (!workers.back()->isValid()) {
+                cerr << "Error creating completion port" << endl;
+                return;
+            }
+        }
+
+        vector<thread> threads;
+        for (auto& worker : workers) {
+            threads.emplace_back([&worker] { worker->run(); });
+        }
+
+        size_t next = 0;
+        while (isRunning) {
+            WSAPOLLFD fd = { serverSocket, POLLRDNORM, 0 };
+            if (WSAPoll(&fd, 1, 1000) <= 0) {
+                continue; // 시간 초과 (stop() 확인) 또는 에러
+            }
+
+            for (int i = 0; i < ACCEPT_BATCH; i++) {
+                SOCKET clientSocket = accept(serverSocket, NULL, NULL);
+                if (clientSocket == INVALID_SOCKET) {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                        cerr << "Error accepting client" << endl;
+                    }
+                    break;
                 }
 
-                send(clientSocket, response.c_str(), response.length(), 0);
-                closesocket(clientSocket);
-                it = clients.erase(it);
-            } else if (bytesRead == 0) {
-                cout << "Client disconnected: " << clientSocket << endl;
-                closesocket(clientSocket);
-                it = clients.erase(it);
-            } else if (WSAGetLastError() != WSAEWOULDBLOCK) {
-                cerr << "Error in recv from client " << clientSocket << endl;
-                closesocket(clientSocket);
-                it = clients.erase(it);
-            } else {
-                ++it;
+                if (!workers[next]->handOff(clientSocket)) {
+                    closesocket(clientSocket);
+                }
+                next = (next + 1) % workers.size();
             }
         }
 
-        memoryPool.dealloc(buffer);
+        for (thread& workerThread : threads) {
+            workerThread.join();
+        }
     }
 };
 
-int main() {
-    MemoryPool pool(sizeof(char) * 1024, 100); // 블록 크기와 초기 예약 크기 설정
-    WebServer server(pool);
+int main(int argc, char* argv[]) {
+    // 첫 번째 인자로 워커 수를 정할 수 있음 (없으면 CPU 코어 수)
+    // 두 번째 인자가 "iocp" 이면 completion port 방식으로 I/O 를 함 (없으면 WSAPoll 준비 상태 방식)
+    size_t workerCount = argc > 1 ? strtoul(argv[1], nullptr, 10) : 0;
+    IoEngine engine = argc > 2 && strcmp(argv[2], "iocp") == 0 ? IoEngine::Completion : IoEngine::Readiness;
+    WebServer server(workerCount, engine);
     server.start(12345);
     return 0;
 }
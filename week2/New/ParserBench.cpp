@@ -0,0 +1,90 @@
+// HttpParser 와 예전 find/substr 방식의 요청 파싱 속도 비교
+// 빌드 예: cl /O2 /std:c++17 /EHsc ParserBench.cpp
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "HttpParser.h"
+
+using namespace std;
+
+// 브라우저가 보내는 것과 비슷한 크기의 요청
+static const char REQUEST[] =
+    "GET /Vegeta HTTP/1.1\r\n"
+    "Host: localhost:12345\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"122\", \"Not(A:Brand\";v=\"24\", \"Google Chrome\";v=\"122\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Referer: http://localhost:12345/\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: ko-KR,ko;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+    "\r\n";
+
+constexpr int ITERATIONS = 2000000;
+
+// 컴파일러가 결과를 버리고 루프를 없애지 않도록 값을 모아둠
+static volatile size_t sink;
+
+template <typename Func>
+void run(const char* name, Func&& parseOnce) {
+    size_t length = sizeof(REQUEST) - 1;
+    size_t check = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        check += parseOnce();
+    }
+    auto end = chrono::steady_clock::now();
+
+    double seconds = chrono::duration<double>(end - start).count();
+    double bytes = static_cast<double>(length) * ITERATIONS;
+    sink = check;
+    cout << name << ": " << (ITERATIONS / seconds / 1e6) << " M req/s, "
+         << (bytes / seconds / 1e9) << " GB/s" << endl;
+}
+
+int main() {
+    cout << "request size: " << sizeof(REQUEST) - 1 << " bytes, " << ITERATIONS << " iterations" << endl;
+
+    // 예전 Ne1.cpp 방식: 버퍼를 string 으로 복사하고 find/substr 로 경로를 꺼냄 (요청마다 할당)
+    run("find/substr", [] {
+        string request(REQUEST);
+        size_t startPos = request.find("GET ") + 4;
+        size_t endPos = request.find(" HTTP/");
+        string path = request.substr(startPos, endPos - startPos);
+        return path.size();
+    });
+
+    // 서버에서처럼 파서와 결과 구조체는 연결마다 한 번 만들어 재사용
+    HttpParser parser;
+    HttpRequest request;
+
+    // HttpParser: 버퍼 안을 가리키는 string_view 만 만들고 헤더 전체를 검사
+    run("HttpParser", [&] {
+        size_t consumed = 0;
+        parser.parse(REQUEST, sizeof(REQUEST) - 1, request, consumed);
+        return request.path.size() + request.headerCount + consumed;
+    });
+
+    // 같은 요청이 여러 번의 recv 로 나눠서 도착하는 경우 (64 바이트씩)
+    run("HttpParser (64B chunks)", [&] {
+        size_t consumed = 0;
+        size_t length = sizeof(REQUEST) - 1;
+        for (size_t received = 64; ; received += 64) {
+            if (received > length) {
+                received = length;
+            }
+            if (parser.parse(REQUEST, received, request, consumed) != HttpParseResult::Incomplete) {
+                break;
+            }
+        }
+        return request.path.size() + consumed;
+    });
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "lib.h"
+
+// 연결 하나의 수신 버퍼
+// recv 는 버퍼의 빈 자리에 바로 받고, 처리한 앞부분은 위치만 옮겨서 버림 (매번 앞으로 당기지 않음)
+// 파서가 요청 하나를 연속된 메모리로 봐야 하므로 끝을 돌아 감기는 대신, 뒤쪽 자리가 모자랄 때만 남은 데이터를 앞으로 옮기거나 두 배로 늘림
+// 메모리는 sizeClassAllocator 에서 받고, 큰 요청 때문에 늘어난 버퍼는 비워지면 처음 크기로 돌려놓음
+class RecvBuffer {
+public:
+    static constexpr size_t INITIAL_CAPACITY = 2048;
+    static constexpr size_t MIN_RECV_SIZE = 512; // recv 한 번에 최소로 확보할 빈 자리
+
+    explicit RecvBuffer(size_t maxCapacity) : maxCapacity(maxCapacity) {}
+
+    RecvBuffer(const RecvBuffer&) = delete;
+    RecvBuffer& operator=(const RecvBuffer&) = delete;
+
+    ~RecvBuffer() {
+        sizeClassAllocator().dealloc(buffer, capacity);
+    }
+
+    // 아직 처리하지 않은 데이터
+    const char* data() const {
+        return buffer + readPos;
+    }
+
+    size_t size() const {
+        return writePos - readPos;
+    }
+
+    // recv 로 받을 빈 자리를 확보해서 반환 (space 에 크기), 최대 크기까지 찼으면 nullptr
+    char* prepare(size_t& space) {
+        if (capacity - writePos < MIN_RECV_SIZE) {
+            size_t pending = size();
+            if (capacity - pending < MIN_RECV_SIZE && capacity < maxCapacity) {
+                grow(max(capacity * 2, INITIAL_CAPACITY));
+            }
+            else if (readPos > 0) {
+                // 처리가 끝난 앞쪽 자리로 남은 데이터를 옮겨서 뒤쪽에 빈 자리를 만듦
+                memmove(buffer, buffer + readPos, pending);
+            }
+            readPos = 0;
+            writePos = pending;
+        }
+
+        space = capacity - writePos;
+        return space > 0 ? buffer + writePos : nullptr;
+    }
+
+    // prepare() 로 받은 자리에 bytes 만큼 데이터가 채워짐
+    void commit(size_t bytes) {
+        writePos += bytes;
+    }
+
+    // 앞에서부터 bytes 만큼 처리가 끝남
+    void consume(size_t bytes) {
+        readPos += bytes;
+        if (readPos == writePos) {
+            // 모두 처리했으면 처음부터 다시 씀 (데이터를 옮길 필요 없음)
+            readPos = writePos = 0;
+            if (capacity > INITIAL_CAPACITY) {
+                sizeClassAllocator().dealloc(buffer, capacity);
+                buffer = nullptr;
+                capacity = 0;
+            }
+        }
+    }
+
+private:
+    char* buffer = nullptr;
+    size_t capacity = 0;
+    size_t readPos = 0;  // 처리하지 않은 데이터의 시작
+    size_t writePos = 0; // 받은 데이터의 끝
+    size_t maxCapacity;
+
+    // 남은 데이터를 새 버퍼의 앞으로 옮김
+    void grow(size_t newCapacity) {
+        newCapacity = min(newCapacity, maxCapacity);
+        char* newBuffer = static_cast<char*>(sizeClassAllocator().alloc(newCapacity));
+        if (size() > 0) {
+            memcpy(newBuffer, buffer + readPos, size());
+        }
+        sizeClassAllocator().dealloc(buffer, capacity);
+        buffer = newBuffer;
+        capacity = newCapacity;
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 경로와 그 경로를 처리할 대상 (정적 페이지, 파일, 처리 함수 등)
+template <typename Target>
+struct Route {
+    std::string_view path;
+    Target target;
+};
+
+// FNV-1a 해시 (컴파일 타임에도 계산 가능)
+constexpr uint32_t routeHash(std::string_view path) {
+    uint32_t hash = 2166136261u;
+    for (char c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// 경로로 Route 를 찾는 해시 테이블 (open addressing)
+// 테이블은 constexpr 로 컴파일 타임에 만들어지고, 같은 경로가 두 번 등록되면 컴파일 에러가 난다
+// 슬롯 수를 경로 수의 두 배 이상으로 잡아서 경로가 늘어나도 해시 한 번과 보통 한 번의 비교로 찾는다
+template <typename Target, size_t N>
+class RouteTable {
+    static constexpr size_t slotCount() {
+        size_t count = 1;
+        while (count < N * 2) {
+            count *= 2;
+        }
+        return count;
+    }
+
+    static constexpr size_t SLOT_COUNT = slotCount();
+
+    struct Slot {
+        uint32_t hash = 0;
+        int index = -1; // routes 안의 위치, -1 이면 빈 슬롯
+    };
+
+    Route<Target> routes[N] = {};
+    Slot slots[SLOT_COUNT] = {};
+
+public:
+    constexpr explicit RouteTable(const Route<Target> (&list)[N]) {
+        for (size_t i = 0; i < N; i++) {
+            routes[i] = list[i];
+
+            uint32_t hash = routeHash(list[i].path);
+            size_t slot = hash & (SLOT_COUNT - 1);
+            while (slots[slot].index >= 0) {
+                if (routes[slots[slot].index].path == list[i].path) {
+                    throw "duplicate route"; // 컴파일 타임에 평가되면 컴파일 에러
+                }
+                slot = (slot + 1) & (SLOT_COUNT - 1);
+            }
+            slots[slot].hash = hash;
+            slots[slot].index = static_cast<int>(i);
+        }
+    }
+
+    // 경로에 해당하는 Route 의 위치를 반환, 없으면 -1
+    constexpr int find(std::string_view path) const {
+        uint32_t hash = routeHash(path);
+        size_t slot = hash & (SLOT_COUNT - 1);
+        while (slots[slot].index >= 0) {
+            if (slots[slot].hash == hash && routes[slots[slot].index].path == path) {
+                return slots[slot].index;
+            }
+            slot = (slot + 1) & (SLOT_COUNT - 1);
+        }
+        return -1;
+    }
+
+    constexpr const Route<Target>& operator[](size_t index) const {
+        return routes[index];
+    }
+
+    static constexpr size_t size() {
+        return N;
+    }
+};
+
+template <typename Target, size_t N>
+constexpr RouteTable<Target, N> makeRouteTable(const Route<Target> (&list)[N]) {
+    return RouteTable<Target, N>(list);
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "lib.h"
+#include <deque>
+
+// 연결 하나의 송신 대기열
+// 보낼 조각들을 순서대로 쌓아 두고 flush() 에서 WSASend 한 번에 여러 조각을 모아서 보낸다
+// 소켓 송신 버퍼가 차서 다 못 보낸 부분은 남겨 두었다가, 소켓이 다시 쓰기 가능해지면 이어서 보낸다 (루프가 기다리지 않음)
+class SendQueue {
+public:
+    enum class FlushResult {
+        Done,    // 모두 보냄
+        Pending, // 송신 버퍼가 차서 일부가 남음 (쓰기 가능해지면 다시 flush)
+        Error,   // 연결 에러
+    };
+
+    static constexpr DWORD MAX_GATHER = 16; // WSASend 한 번에 모을 최대 조각 수
+
+    SendQueue() = default;
+
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    SendQueue(SendQueue&& other) noexcept : segments(move(other.segments)), pending(other.pending) {
+        other.segments.clear();
+        other.pending = 0;
+    }
+
+    SendQueue& operator=(SendQueue&& other) noexcept {
+        if (this != &other) {
+            clear();
+            segments = move(other.segments);
+            pending = other.pending;
+            other.segments.clear();
+            other.pending = 0;
+        }
+        return *this;
+    }
+
+    ~SendQueue() {
+        clear();
+    }
+
+    // 다 보낼 때까지 바뀌지 않는 데이터 (미리 만든 헤더, 정적 본문 등) 는 복사하지 않고 가리키기만 함
+    // owner 를 넘기면 그 조각을 다 보낼 때까지 owner 를 붙잡아 둠 (다시 읽힌 캐시, 매핑된 파일 등)
+    void pushRef(const char* data, size_t size, shared_ptr<const void> owner = nullptr) {
+        // WSABUF 의 길이는 ULONG 이므로 아주 큰 조각은 나눠서 넣음
+        while (size > 0) {
+            size_t length = min(size, MAX_SEGMENT_SIZE);
+            segments.push_back(Segment{ data, length, nullptr, 0, owner });
+            pending += length;
+            data += length;
+            size -= length;
+        }
+    }
+
+    // 곧 사라지는 데이터 (요청마다 만든 헤더와 본문) 는 풀 메모리에 복사해서 보관
+    // 마지막 조각이 복사본이고 자리가 남아 있으면 거기에 이어 붙임 (작은 응답 여러 개가 조각 하나로 모임)
+    void pushCopy(const char* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        if (!segments.empty()) {
+            Segment& last = segments.back();
+            if (last.owned != nullptr && last.data + last.size + size <= last.owned + last.ownedSize) {
+                memcpy(const_cast<char*>(last.data) + last.size, data, size);
+                last.size += size;
+                pending += size;
+                return;
+            }
+        }
+
+        // 아주 큰 데이터는 MAX_SEGMENT_SIZE 씩 나눠서 복사
+        if (size > MAX_SEGMENT_SIZE) {
+            while (size > 0) {
+                size_t length = min(size, MAX_SEGMENT_SIZE);
+                pushCopy(data, length);
+                data += length;
+                size -= length;
+            }
+            return;
+        }
+
+        size_t ownedSize = max(size, MIN_COPY_SIZE);
+        char* owned = static_cast<char*>(sizeClassAllocator().alloc(ownedSize));
+        memcpy(owned, data, size);
+        segments.push_back(Segment{ owned, size, owned, ownedSize, nullptr });
+        pending += size;
+    }
+
+    // 쌓인 조각을 보낼 수 있는 만큼 보냄
+    FlushResult flush(SOCKET sock) {
+        while (!segments.empty()) {
+            WSABUF bufs[MAX_GATHER];
+            size_t total = 0;
+            DWORD count = gather(bufs, total);
+
+            DWORD sent = 0;
+            if (WSASend(sock, bufs, count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+                return WSAGetLastError() == WSAEWOULDBLOCK ? FlushResult::Pending : FlushResult::Error;
+            }
+            consume(sent);
+
+            if (sent < total) {
+                return FlushResult::Pending; // 송신 버퍼가 참
+            }
+        }
+        return FlushResult::Done;
+    }
+
+    // 앞에서부터 최대 MAX_GATHER 개의 조각을 bufs 에 채우고 그 개수를 반환 (total 에 바이트 수)
+    // overlapped WSASend 처럼 flush() 를 쓰지 않고 직접 보낼 때 사용하고, 보낸 뒤에는 consume() 을 호출
+    DWORD gather(WSABUF* bufs, size_t& total) const {
+        DWORD count = 0;
+        total = 0;
+        for (auto it = segments.begin(); it != segments.end() && count < MAX_GATHER; ++it, ++count) {
+            bufs[count].buf = const_cast<char*>(it->data);
+            bufs[count].len = static_cast<ULONG>(it->size);
+            total += it->size;
+        }
+        return count;
+    }
+
+    // 앞에서부터 bytes 만큼 보낸 것으로 처리
+    void consume(size_t bytes) {
+        pending -= bytes;
+        while (bytes > 0) {
+            Segment& front = segments.front();
+            if (bytes < front.size) {
+                front.data += bytes;
+                front.size -= bytes;
+                return;
+            }
+            bytes -= front.size;
+            sizeClassAllocator().dealloc(front.owned, front.ownedSize);
+            segments.pop_front();
+        }
+    }
+
+    // 아직 보내지 못한 바이트 수
+    size_t pendingBytes() const {
+        return pending;
+    }
+
+    bool empty() const {
+        return segments.empty();
+    }
+
+    void clear() {
+        for (Segment& segment : segments) {
+            sizeClassAllocator().dealloc(segment.owned, segment.ownedSize);
+        }
+        segments.clear();
+        pending = 0;
+    }
+
+private:
+    struct Segment {
+        const char* data;              // 아직 보내지 않은 부분의 시작
+        size_t size;                   // 아직 보내지 않은 길이
+        char* owned;                   // 복사본이면 풀에서 받은 메모리 (다 보내면 해제)
+        size_t ownedSize;
+        shared_ptr<const void> owner;  // 가리키는 데이터를 붙잡아 둘 객체
+    };
+
+    static constexpr size_t MIN_COPY_SIZE = 1024; // 복사본 조각의 최소 크기 (뒤에 오는 작은 응답을 이어 붙일 자리)
+    static constexpr size_t MAX_SEGMENT_SIZE = 1 << 30;
+
+    deque<Segment, PoolAllocator<Segment>> segments;
+    size_t pending = 0;
+};
@@ -0,0 +1,156 @@
+// Ne1 웹 서버의 I/O 방식 (WSAPoll 준비 상태 / I/O completion port) 별 초당 요청 수와 요청당 소켓 함수 호출 수 비교
+// 서버를 방식마다 따로 띄워 두고 이 프로그램을 실행: Ne1.exe 4 → ServerBench, Ne1.exe 4 iocp → ServerBench
+// 요청당 소켓 함수 호출 수는 실행 전후의 /status 페이지 (Requests served, Socket calls) 차이로 계산
+// 빌드 예: cl /O2 /std:c++17 /EHsc ServerBench.cpp ws2_32.lib
+#include "lib.h"
+#include <chrono>
+
+constexpr int PORT = 12345;
+
+// 서버에 연결된 블로킹 소켓을 만듦
+SOCKET connectToServer() {
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+
+    SOCKADDR_IN addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(PORT);
+    if (connect(sock, reinterpret_cast<SOCKADDR*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+    return sock;
+}
+
+// /status 페이지에서 label 뒤의 숫자를 읽음
+size_t readStat(const string& page, const char* label) {
+    size_t pos = page.find(label);
+    return pos == string::npos ? 0 : strtoull(page.c_str() + pos + strlen(label), nullptr, 10);
+}
+
+// /status 페이지를 받아서 처리한 요청 수와 소켓 함수 호출 수를 읽음
+bool readStatus(size_t& requests, size_t& socketCalls) {
+    SOCKET sock = connectToServer();
+    if (sock == INVALID_SOCKET) {
+        return false;
+    }
+
+    const char request[] = "GET /status HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    send(sock, request, sizeof(request) - 1, 0);
+
+    string page;
+    char buf[4096];
+    int received;
+    while ((received = recv(sock, buf, sizeof(buf), 0)) > 0) {
+        page.append(buf, received);
+    }
+    closesocket(sock);
+
+    requests = readStat(page, "Requests served: ");
+    socketCalls = readStat(page, "Socket calls: ");
+    return true;
+}
+
+// 연결 하나에서 depth 개씩 요청을 한꺼번에 보내고 (파이프라이닝) 응답이 모두 오면 다시 보내는 것을 반복
+// 응답 수는 헤더 끝 (빈 줄) 개수로 셈 (벤치마크 페이지의 본문에는 빈 줄이 없음)
+void runConnection(const string& path, int depth, const atomic<bool>& go, const atomic<bool>& done, atomic<size_t>& completed) {
+    SOCKET sock = connectToServer();
+    if (sock == INVALID_SOCKET) {
+        cerr << "Error connecting to server" << endl;
+        return;
+    }
+
+    string requests;
+    for (int i = 0; i < depth; i++) {
+        requests += "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    while (!go) {
+        this_thread::yield();
+    }
+
+    size_t count = 0;
+    char buf[16384];
+    uint32_t tail = 0; // 직전까지 받은 마지막 4 바이트 (빈 줄이 recv 경계에 걸쳐도 찾도록)
+    while (!done) {
+        if (send(sock, requests.data(), static_cast<int>(requests.size()), 0) == SOCKET_ERROR) {
+            break;
+        }
+
+        int pending = depth;
+        while (pending > 0) {
+            int received = recv(sock, buf, sizeof(buf), 0);
+            if (received <= 0) {
+                pending = -1;
+                break;
+            }
+            for (int i = 0; i < received; i++) {
+                tail = (tail << 8) | static_cast<uint8_t>(buf[i]);
+                if (tail == 0x0D0A0D0A) { // "\r\n\r\n"
+                    pending--;
+                }
+            }
+        }
+        if (pending < 0) {
+            cerr << "Connection closed by server" << endl;
+            break;
+        }
+        count += depth;
+    }
+
+    completed += count;
+    closesocket(sock);
+}
+
+int main(int argc, char* argv[]) {
+    // 인자: 연결 수, 측정 시간 (초), 파이프라이닝 깊이
+    int connections = argc > 1 ? atoi(argv[1]) : 32;
+    int seconds = argc > 2 ? atoi(argv[2]) : 5;
+    int depth = argc > 3 ? atoi(argv[3]) : 1;
+    const string path = "/Goku";
+
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    size_t startRequests = 0, startCalls = 0;
+    if (!readStatus(startRequests, startCalls)) {
+        cerr << "Server is not running on port " << PORT << endl;
+        WSACleanup();
+        return 1;
+    }
+
+    cout << connections << " connections, " << seconds << " s, pipeline depth " << depth << ", GET " << path << endl;
+
+    atomic<bool> go{ false }, done{ false };
+    atomic<size_t> completed{ 0 };
+    vector<thread> threads;
+    for (int i = 0; i < connections; i++) {
+        threads.emplace_back(runConnection, cref(path), depth, cref(go), cref(done), ref(completed));
+    }
+
+    auto start = chrono::steady_clock::now();
+    go = true;
+    this_thread::sleep_for(chrono::seconds(seconds));
+    done = true;
+    for (thread& t : threads) {
+        t.join();
+    }
+    auto end = chrono::steady_clock::now();
+
+    size_t endRequests = 0, endCalls = 0;
+    readStatus(endRequests, endCalls);
+
+    double elapsed = chrono::duration<double>(end - start).count();
+    size_t served = endRequests - startRequests;
+    cout << "  " << (completed / elapsed) << " req/s" << endl;
+    if (served > 0) {
+        cout << "  " << (static_cast<double>(endCalls - startCalls) / served) << " socket calls/request (server side)" << endl;
+    }
+
+    WSACleanup();
+    return 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// 계층형 타이머 휠 (연결마다 하나씩 거는 읽기/송신/keep-alive 제한 시간용)
+// 시간을 TICK_MS 단위 눈금으로 나누고, 가까운 타이머는 0단계 바퀴에, 먼 타이머는 윗단계 바퀴에 넣는다
+// 윗단계 칸은 아랫단계 바퀴가 한 바퀴 돌 때마다 한 칸씩 아래로 내려가서 (cascade) 결국 0단계에서 만료된다
+// 타이머는 연결 안에 들어 있는 이중 연결 리스트 노드라서 등록과 취소가 O(1) 이고 메모리를 따로 할당하지 않음
+class TimerWheel {
+public:
+    static constexpr uint64_t TICK_MS = 10;
+
+    // 연결 안에 넣어 두는 타이머 노드
+    struct Timer {
+        Timer* prev = nullptr;
+        Timer* next = nullptr; // nullptr 이면 등록되지 않은 상태
+        uint64_t expiry = 0;   // 만료 눈금
+        uintptr_t key = 0;     // 만료되었을 때 누구의 타이머인지 알려줄 값 (소켓 등)
+
+        bool scheduled() const {
+            return next != nullptr;
+        }
+    };
+
+    explicit TimerWheel(uint64_t nowMs) : currentTick(nowMs / TICK_MS), count(0) {
+        for (Timer& slot : slots) {
+            slot.prev = slot.next = &slot;
+        }
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // timer 를 deadlineMs 에 만료되도록 등록 (이미 등록되어 있으면 옮김)
+    void schedule(Timer& timer, uint64_t deadlineMs) {
+        cancel(timer);
+        timer.expiry = (deadlineMs + TICK_MS - 1) / TICK_MS;
+        insert(timer, currentTick + 1); // 현재 눈금은 이미 처리했으므로 지난 타이머는 다음 눈금에 만료
+        count++;
+    }
+
+    void cancel(Timer& timer) {
+        if (!timer.scheduled()) {
+            return;
+        }
+        unlink(timer);
+        count--;
+    }
+
+    // nowMs 까지 눈금을 진행하면서 만료된 타이머마다 onExpired(timer) 를 호출
+    // 콜백이 호출될 때 timer 는 이미 빠져 있으므로 콜백 안에서 다시 등록하거나 타이머를 가진 객체를 지워도 됨
+    template <typename OnExpired>
+    void advance(uint64_t nowMs, OnExpired&& onExpired) {
+        uint64_t targetTick = nowMs / TICK_MS;
+        while (currentTick < targetTick) {
+            if (count == 0) {
+                currentTick = targetTick; // 등록된 타이머가 없으면 눈금을 하나씩 돌 필요 없음
+                return;
+            }
+
+            uint64_t tick = ++currentTick;
+            // 아랫단계가 한 바퀴를 다 돌았으면 윗단계의 다음 칸을 아래로 내림 (가장 높은 단계부터)
+            int level = 0;
+            while (level + 1 < LEVELS && ((tick >> (SLOT_BITS * (level + 1))) << (SLOT_BITS * (level + 1))) == tick) {
+                level++;
+            }
+            for (; level > 0; level--) {
+                cascade(level, (tick >> (SLOT_BITS * level)) & SLOT_MASK);
+            }
+
+            Timer& slot = slots[tick & SLOT_MASK];
+            while (slot.next != &slot) {
+                Timer& timer = *slot.next;
+                unlink(timer);
+                count--;
+                onExpired(timer);
+            }
+        }
+    }
+
+    // 다음 타이머가 만료될 수 있는 시각까지 남은 시간 (최대 maxMs, 대기 함수의 timeout 으로 사용)
+    // 0단계에 타이머가 있으면 그 눈금까지, 윗단계에만 있으면 다음 cascade 까지 기다림
+    int timeoutMs(uint64_t nowMs, int maxMs) const {
+        if (count == 0) {
+            return maxMs;
+        }
+
+        uint64_t nextTick = (currentTick | SLOT_MASK) + 1;
+        for (uint64_t tick = currentTick + 1; tick < nextTick; tick++) {
+            const Timer& slot = slots[tick & SLOT_MASK];
+            if (slot.next != &slot) {
+                nextTick = tick;
+                break;
+            }
+        }
+
+        uint64_t wakeMs = nextTick * TICK_MS;
+        if (wakeMs <= nowMs) {
+            return 0;
+        }
+        return wakeMs - nowMs < static_cast<uint64_t>(maxMs) ? static_cast<int>(wakeMs - nowMs) : maxMs;
+    }
+
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr uint64_t SLOT_MASK = (1 << SLOT_BITS) - 1;
+    static constexpr int LEVELS = 4; // 10ms 눈금으로 64^4 눈금 = 약 46시간까지
+    static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    Timer slots[LEVELS << SLOT_BITS]; // 칸마다 원형 리스트의 머리 노드 (단계 * 64 + 칸)
+    uint64_t currentTick;             // 마지막으로 처리한 (또는 처리 중인) 눈금
+    size_t count;                     // 등록된 타이머 수
+
+    // 만료 눈금과 현재 눈금의 차이로 들어갈 단계와 칸을 정함 (earliest 보다 이른 타이머는 earliest 에 만료)
+    void insert(Timer& timer, uint64_t earliest) {
+        uint64_t expiry = timer.expiry > earliest ? timer.expiry : earliest;
+        uint64_t delta = expiry - currentTick;
+        if (delta > MAX_DELTA) {
+            expiry = currentTick + MAX_DELTA; // 너무 먼 타이머는 맨 윗단계 끝에 두었다가 내려올 때 다시 자리를 찾음
+            delta = MAX_DELTA;
+        }
+
+        int level = 0;
+        while ((delta >> (SLOT_BITS * (level + 1))) != 0) {
+            level++;
+        }
+        Timer& slot = slots[(level << SLOT_BITS) + ((expiry >> (SLOT_BITS * level)) & SLOT_MASK)];
+
+        timer.prev = slot.prev;
+        timer.next = &slot;
+        slot.prev->next = &timer;
+        slot.prev = &timer;
+    }
+
+    static void unlink(Timer& timer) {
+        timer.prev->next = timer.next;
+        timer.next->prev = timer.prev;
+        timer.prev = timer.next = nullptr;
+    }
+
+    // 윗단계 칸의 타이머를 모두 꺼내서 현재 눈금 기준으로 다시 넣음 (이번 눈금에 만료될 타이머는 곧 처리할 0단계 칸으로)
+    void cascade(int level, uint64_t index) {
+        Timer& slot = slots[(level << SLOT_BITS) + index];
+        Timer* timer = slot.next;
+        slot.prev = slot.next = &slot;
+        while (timer != &slot) {
+            Timer* next = timer->next;
+            insert(*timer, currentTick);
+            timer = next;
+        }
+    }
+};
@@ -28,6 +28,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
+#include <string>
+#include <memory_resource>
 
 using namespace std;
 
@@ -39,70 +41,256 @@ using namespace std;
 	} \
 }
 
+// 스레드마다 작은 번호(슬롯)를 하나씩 나눠줌
+// 스레드가 끝나면 번호를 돌려받아 다음에 만들어지는 스레드가 다시 사용함
+class ThreadSlot {
+public:
+	static constexpr int MAX_SLOTS = 128;
+
+	// 현재 스레드의 슬롯 번호 (슬롯이 모두 사용 중이면 -1)
+	static int current() {
+		thread_local ThreadSlot slot;
+		return slot.id;
+	}
+
+private:
+	int id;
+
+	inline static mutex mtx;
+	inline static vector<int> released; // 끝난 스레드가 돌려준 번호
+	inline static int nextId = 0;
+
+	ThreadSlot() {
+		lock_guard<mutex> lock(mtx);
+		if (!released.empty()) {
+			id = released.back();
+			released.pop_back();
+		}
+		else {
+			id = nextId < MAX_SLOTS ? nextId++ : -1;
+		}
+	}
+
+	~ThreadSlot() {
+		if (id >= 0) {
+			lock_guard<mutex> lock(mtx);
+			released.push_back(id);
+		}
+	}
+};
+
 // 고정 크기 메모리 할당을 위한 pointer 메모리 풀
+// 스레드마다 블록 캐시를 두어 alloc/dealloc 은 보통 락도 원자 연산도 없이 끝나고,
+// 캐시가 비거나 넘칠 때만 BATCH_SIZE 개씩 묶어서 전역 lock-free 스택(SLIST)과 주고받음
+// 블록은 VirtualAlloc 으로 받은 큰 덩어리(chunk)를 잘라서 만들므로 블록마다 힙 할당을 하지 않고, 이웃한 블록이 메모리에서도 붙어 있음
 class MemoryPool {
+	// 비어 있는 블록 안에 직접 저장하는 연결 정보 (빈 블록을 따로 담아둘 벡터가 필요 없음)
+	struct FreeBlock {
+		SLIST_ENTRY entry; // 묶음의 첫 블록일 때 전역 스택에 연결하는 데 사용
+		FreeBlock* next; // 같은 묶음(또는 스레드 캐시) 안의 다음 블록
+		size_t count; // 묶음의 첫 블록일 때 묶음 안의 블록 수
+	};
+
+	// 스레드 하나만 사용하는 캐시 (다른 스레드의 캐시와 캐시 라인을 나눠 쓰지 않도록 정렬)
+	struct alignas(64) ThreadCache {
+		FreeBlock* head = nullptr;
+		size_t count = 0;
+	};
+
+	static constexpr size_t BATCH_SIZE = 32;
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+	static constexpr size_t CHUNK_SIZE = 64 * 1024; // VirtualAlloc 의 할당 단위
+
 	size_t blockSize;
-	vector<char*> freeBlocks; // 고정 블록을 가리키는 포인터 벡터
+	size_t alignment; // 모든 블록의 시작 주소가 이 값의 배수
+	SLIST_HEADER batches; // 블록 묶음의 전역 스택 (Windows SLIST 는 ABA 문제를 막는 카운터를 함께 비교함)
+	ThreadCache caches[ThreadSlot::MAX_SLOTS];
+
+	// 아래는 블록을 새로 만들 때만 사용 (mtx 로 보호)
 	mutex mtx;
+	vector<void*> chunks; // 소멸자에서 해제할 덩어리 목록
+	char* chunkCursor = nullptr; // 현재 덩어리에서 아직 블록으로 자르지 않은 부분
+	char* chunkEnd = nullptr;
+	size_t chunkSize; // 덩어리 하나의 크기
+	bool largePages; // 큰 페이지(2MB)로 덩어리를 받을지 (실패하면 일반 페이지로 바꿈)
 
 public:
 	// explicit: 묵시적 변환을 막음 == 반드시 생성자 호출을 통해서만 객체 생성 가능
-	explicit MemoryPool(size_t blockSize, size_t reserve = 0) : blockSize(blockSize) {
-		freeBlocks.reserve(reserve); // 임시 크기를 미리 할당, 속도 UP, 메모리 효율 DOWN
+	// largePages: 큰 페이지를 쓰면 TLB 미스가 줄어듦 (계정에 SeLockMemoryPrivilege 가 있어야 하고, 없으면 일반 페이지를 사용)
+	explicit MemoryPool(size_t blockSize, size_t reserve = 0, bool largePages = false) : largePages(largePages) {
+		// 빈 블록에 연결 정보를 저장할 수 있는 크기로 맞추고, 블록 크기를 정렬 단위의 배수로 올림
+		// 캐시 라인보다 큰 블록은 캐시 라인에 맞춰서 블록 하나가 다른 블록과 캐시 라인을 나눠 쓰지 않도록 함
+		blockSize = max(blockSize, sizeof(FreeBlock));
+		alignment = blockSize >= CACHE_LINE_SIZE ? CACHE_LINE_SIZE : MEMORY_ALLOCATION_ALIGNMENT;
+		this->blockSize = (blockSize + alignment - 1) & ~(alignment - 1);
 
-		for (size_t i = 0; i < reserve; i++) {
-			freeBlocks.push_back(new char[blockSize]); // 고정 크기의 블록을 생성하여 벡터에 추가
+		// 덩어리 하나에서 묶음 하나 이상이 나오도록 함
+		chunkSize = CHUNK_SIZE;
+		while (chunkSize < this->blockSize * BATCH_SIZE) {
+			chunkSize *= 2;
 		}
+
+		InitializeSListHead(&batches);
+		resize(reserve); // 임시 크기를 미리 할당, 속도 UP, 메모리 효율 DOWN
 	}
 
 	~MemoryPool() {
-		for (char* block : freeBlocks) {
-			delete[] block; // 벡터에 추가된 블록을 모두 삭제
+		for (void* chunk : chunks) {
+			VirtualFree(chunk, 0, MEM_RELEASE); // 덩어리를 모두 해제 (블록도 함께 사라짐)
 		}
 	}
 
-	void* alloc() {
-		// 뮤텍스를 이용하여 동시성 문제 해결
-		lock_guard<mutex> lock(mtx);
+	size_t getBlockSize() const {
+		return blockSize;
+	}
 
-		void* block;
+	size_t getAlignment() const {
+		return alignment;
+	}
 
-		if (!freeBlocks.empty()) { // 블록이 남아있으면
-			block = freeBlocks.back(); // 가장 최근에 추가된 블록을 가리키는 포인터를 반환
-			freeBlocks.pop_back(); // 블록은 벡터에서 제거
+	void* alloc() {
+		int slot = ThreadSlot::current();
+		if (slot < 0) {
+			return allocShared();
 		}
-		else {
-			block = new char[blockSize]; // 블록이 없으면 새로 생성
+
+		ThreadCache& cache = caches[slot];
+		if (cache.head == nullptr) {
+			// 캐시가 비었으면 전역 스택에서 묶음 하나를 가져옴 (없으면 새로 생성)
+			FreeBlock* batch = popBatch();
+			cache.head = batch;
+			cache.count = batch->count;
 		}
 
+		FreeBlock* block = cache.head;
+		cache.head = block->next;
+		cache.count--;
 		return block; // 블록을 가리키는 포인터(+블록) 반환
 	}
 
 	void dealloc(void* ptr) {
-		// 뮤텍스를 이용하여 동시성 문제 해결
-		lock_guard<mutex> lock(mtx);
+		if (ptr == nullptr) {
+			return;
+		}
 
-		if (ptr != nullptr) {
-			// 블록을 가리키는 포인터를 벡터에 추가
-			// (외부에서 void*로 넘어온 포인터를 내부에서 char*로 캐스팅)
-			freeBlocks.push_back(reinterpret_cast<char*>(ptr));
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		int slot = ThreadSlot::current();
+		if (slot < 0) {
+			block->next = nullptr;
+			block->count = 1;
+			InterlockedPushEntrySList(&batches, &block->entry);
+			return;
+		}
+
+		ThreadCache& cache = caches[slot];
+		block->next = cache.head;
+		cache.head = block;
+		cache.count++;
+
+		// 캐시가 너무 커지면 앞쪽 BATCH_SIZE 개를 묶어서 다른 스레드가 쓸 수 있도록 전역 스택에 돌려줌
+		if (cache.count >= BATCH_SIZE * 2) {
+			FreeBlock* batch = cache.head;
+			FreeBlock* last = batch;
+			for (size_t i = 1; i < BATCH_SIZE; i++) {
+				last = last->next;
+			}
+			cache.head = last->next;
+			cache.count -= BATCH_SIZE;
+
+			last->next = nullptr;
+			batch->count = BATCH_SIZE;
+			InterlockedPushEntrySList(&batches, &batch->entry);
 		}
 	}
 
 	void resize(size_t addreserve) {
-		// 뮤텍스를 이용하여 동시성 문제 해결
-		lock_guard<mutex> lock(mtx);
+		// 블록을 묶음 단위로 추가로 생성하여 전역 스택에 추가
+		while (addreserve > 0) {
+			size_t count = min(addreserve, BATCH_SIZE);
+			InterlockedPushEntrySList(&batches, &createBatch(count)->entry);
+			addreserve -= count;
+		}
+	}
+
+private:
+	// 묶음의 첫 블록은 SLIST_ENTRY 위치에 있으므로 그대로 FreeBlock 으로 바꿀 수 있음
+	FreeBlock* popBatch() {
+		PSLIST_ENTRY entry = InterlockedPopEntrySList(&batches);
+		return entry != nullptr ? reinterpret_cast<FreeBlock*>(entry) : createBatch(BATCH_SIZE);
+	}
+
+	// 덩어리에서 블록 count 개를 잘라 하나의 묶음으로 연결
+	FreeBlock* createBatch(size_t count) {
+		FreeBlock* head = nullptr;
+		FreeBlock* last = nullptr;
+		{
+			lock_guard<mutex> lock(mtx); // 블록을 새로 만들 때만 락을 잡음
+			for (size_t i = 0; i < count; i++) {
+				if (chunkCursor == chunkEnd) {
+					allocChunk();
+				}
+
+				// 주소 순서대로 연결해서 연속으로 할당한 블록이 메모리에서도 이웃하도록 함
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(chunkCursor);
+				chunkCursor += blockSize;
+				block->next = nullptr;
+				if (last == nullptr) {
+					head = block;
+				}
+				else {
+					last->next = block;
+				}
+				last = block;
+			}
+		}
+		head->count = count;
+		return head;
+	}
+
+	// 새 덩어리를 받아서 블록으로 자를 준비를 함 (mtx 를 잡은 상태에서 호출)
+	void allocChunk() {
+		void* chunk = nullptr;
+		size_t size = chunkSize;
+
+		if (largePages) {
+			size_t largePageSize = GetLargePageMinimum();
+			if (largePageSize != 0) {
+				size = (chunkSize + largePageSize - 1) & ~(largePageSize - 1);
+				chunk = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			}
+			if (chunk == nullptr) {
+				largePages = false; // 권한이 없거나 지원하지 않으면 이후로는 일반 페이지 사용
+				size = chunkSize;
+			}
+		}
+		if (chunk == nullptr) {
+			chunk = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		}
+		if (chunk == nullptr) {
+			throw bad_alloc();
+		}
+
+		chunks.push_back(chunk);
+		// 덩어리는 페이지 경계에서 시작하고 blockSize 는 alignment 의 배수이므로 모든 블록이 정렬됨
+		chunkCursor = static_cast<char*>(chunk);
+		chunkEnd = chunkCursor + size / blockSize * blockSize;
+	}
 
-		// 벡터의 크기를 늘리고, 블록을 추가로 생성하여 벡터에 추가
-		freeBlocks.reserve(freeBlocks.capacity() + addreserve);
-		for (size_t i = 0; i < addreserve; i++) {
-			freeBlocks.push_back(new char[blockSize]); // 고정 크기의 블록을 생성하여 벡터에 추가
+	// 슬롯을 받지 못한 스레드는 캐시 없이 전역 스택에서 직접 한 블록씩 주고받음
+	void* allocShared() {
+		FreeBlock* batch = popBatch();
+		if (batch->next != nullptr) {
+			FreeBlock* rest = batch->next;
+			rest->count = batch->count - 1;
+			InterlockedPushEntrySList(&batches, &rest->entry);
 		}
+		return batch;
 	}
 };
 
 template <typename T, typename... Args> // 가변인자 템플릿: 임의의 개수의 인자를 받을 수 있음
 T* MemPool_new(MemoryPool& pool, Args&&... args) { // 완벽 전달: 인자를 그대로 전달
+	assert(sizeof(T) <= pool.getBlockSize() && alignof(T) <= pool.getAlignment()); // 블록에 T 가 들어가는지 확인
 	T* block = reinterpret_cast<T*>(pool.alloc()); // void*를 할당 후 T*로 캐스팅  
 	return new(block) T(forward<Args>(args)...); // 생성자 호출
 	// forward<Args>(args)...: 완벽 전달된 인자를 생성자에 전달
@@ -116,6 +304,201 @@ void MemPool_delete(MemoryPool& pool, T* ptr) {
 	}
 }
 
+// 여러 크기의 메모리를 크기별 MemoryPool 에서 할당하는 할당자
+// 64B ~ 64KB 를 2의 거듭제곱 크기 단위(size class)로 나누고, 요청한 크기를 담을 수 있는 가장 작은 단위의 풀에서 블록을 줌
+// 64KB 보다 큰 요청은 드물다고 보고 그냥 operator new 로 처리함
+class SizeClassAllocator {
+public:
+	static constexpr size_t MIN_SIZE = 64;
+	static constexpr size_t MAX_SIZE = 64 * 1024;
+	static constexpr size_t CLASS_COUNT = 11; // 64, 128, ..., 64K
+
+	SizeClassAllocator() {
+		for (size_t i = 0; i < CLASS_COUNT; i++) {
+			pools[i] = make_unique<MemoryPool>(MIN_SIZE << i);
+		}
+	}
+
+	void* alloc(size_t size) {
+		if (size > MAX_SIZE) {
+			largeAllocations.fetch_add(1, memory_order_relaxed);
+			return ::operator new(size);
+		}
+		return pools[sizeClass(size)]->alloc();
+	}
+
+	// size 는 alloc 할 때 넘긴 크기와 같아야 함 (어느 풀의 블록인지 크기로 찾음)
+	void dealloc(void* ptr, size_t size) {
+		if (ptr == nullptr) {
+			return;
+		}
+		if (size > MAX_SIZE) {
+			::operator delete(ptr);
+			return;
+		}
+		pools[sizeClass(size)]->dealloc(ptr);
+	}
+
+	// 풀에서 처리하지 못하고 operator new 로 넘긴 횟수
+	size_t getLargeAllocations() const {
+		return largeAllocations.load(memory_order_relaxed);
+	}
+
+	// size 를 담을 수 있는 가장 작은 size class 번호
+	static size_t sizeClass(size_t size) {
+		size_t index = 0;
+		while ((MIN_SIZE << index) < size) {
+			index++;
+		}
+		return index;
+	}
+
+private:
+	unique_ptr<MemoryPool> pools[CLASS_COUNT];
+	atomic<size_t> largeAllocations{ 0 };
+};
+
+// 프로그램 전체가 같이 쓰는 SizeClassAllocator
+// 일부러 해제하지 않음: 프로그램이 끝날 때 다른 전역 객체의 소멸자가 이 할당자로 메모리를 돌려줄 수 있으므로
+inline SizeClassAllocator& sizeClassAllocator() {
+	static SizeClassAllocator* allocator = new SizeClassAllocator();
+	return *allocator;
+}
+
+// 표준 컨테이너에 넘길 수 있는 할당자 (string, vector, unordered_map 등의 메모리를 sizeClassAllocator 에서 받음)
+template <typename T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	static_assert(alignof(T) <= MEMORY_ALLOCATION_ALIGNMENT, "PoolAllocator only guarantees MEMORY_ALLOCATION_ALIGNMENT");
+
+	PoolAllocator() noexcept = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n) {
+		return static_cast<T*>(sizeClassAllocator().alloc(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t n) noexcept {
+		sizeClassAllocator().dealloc(ptr, n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const noexcept {
+		return true; // 모두 같은 할당자를 쓰므로 어느 쪽에서 할당한 메모리든 해제할 수 있음
+	}
+
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>&) const noexcept {
+		return false;
+	}
+};
+
+using PoolString = basic_string<char, char_traits<char>, PoolAllocator<char>>;
+
+// 요청 하나를 처리하는 동안 쓰는 임시 메모리를 앞에서부터 잘라 주는 할당자 (bump pointer)
+// 개별 해제는 하지 않고 reset() 으로 한꺼번에 되돌리므로 요청마다 할당/해제 비용이 거의 없음
+// pmr::memory_resource 이므로 pmr::string, pmr::vector 등에 넘겨서 그대로 사용할 수 있음
+// 메모리 블록은 sizeClassAllocator 에서 받고, 첫 블록은 reset() 뒤에도 남겨서 다음 요청이 재사용함
+class Arena : public pmr::memory_resource {
+	// 블록 앞에 붙는 정보
+	struct Block {
+		Block* prev; // 이전에 받은 블록
+		size_t size; // Block 을 포함한 블록 전체 크기
+	};
+
+	size_t initialSize;
+	Block* first = nullptr; // 처음 받은 블록 (reset() 해도 유지)
+	Block* current = nullptr; // 지금 잘라 쓰고 있는 블록
+	char* cursor = nullptr;
+	char* end = nullptr;
+
+public:
+	explicit Arena(size_t initialSize = 4096) : initialSize(initialSize) {}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	~Arena() {
+		release(nullptr);
+	}
+
+	// 지금까지 할당한 메모리를 모두 되돌림 (보통은 첫 블록 하나만 있으므로 포인터만 되감음)
+	void reset() {
+		if (current != first) {
+			release(first);
+		}
+		if (first != nullptr) {
+			cursor = reinterpret_cast<char*>(first + 1);
+		}
+	}
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		char* ptr = align(cursor, alignment);
+		if (ptr == nullptr || ptr + bytes > end) {
+			addBlock(bytes + alignment);
+			ptr = align(cursor, alignment);
+		}
+		cursor = ptr + bytes;
+		return ptr;
+	}
+
+	void do_deallocate(void*, size_t, size_t) override {
+		// 개별 해제는 하지 않음 (reset() 에서 한꺼번에 되돌림)
+	}
+
+	bool do_is_equal(const memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+private:
+	static char* align(char* ptr, size_t alignment) {
+		if (ptr == nullptr) {
+			return nullptr;
+		}
+		uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<char*>((address + alignment - 1) & ~(alignment - 1));
+	}
+
+	// 최소 bytes 를 담을 수 있는 블록을 새로 받음 (블록 크기는 앞 블록의 두 배씩 늘어남)
+	void addBlock(size_t bytes) {
+		size_t size = current != nullptr ? current->size * 2 : initialSize;
+		while (size < bytes + sizeof(Block)) {
+			size *= 2;
+		}
+
+		Block* block = static_cast<Block*>(sizeClassAllocator().alloc(size));
+		block->prev = current;
+		block->size = size;
+		if (first == nullptr) {
+			first = block;
+		}
+		current = block;
+		cursor = reinterpret_cast<char*>(block + 1);
+		end = reinterpret_cast<char*>(block) + size;
+	}
+
+	// keep 보다 나중에 받은 블록을 모두 해제 (keep 이 nullptr 이면 전부 해제)
+	void release(Block* keep) {
+		while (current != keep) {
+			Block* prev = current->prev;
+			sizeClassAllocator().dealloc(current, current->size);
+			current = prev;
+		}
+		if (keep == nullptr) {
+			first = nullptr;
+			cursor = end = nullptr;
+		}
+		else {
+			end = reinterpret_cast<char*>(keep) + keep->size;
+		}
+	}
+};
+
 // 템플릿 기반의 객체 메모리 풀, 유연한 크기의 객체를 지원하지만 성능이 떨어짐
 // template <typename T>
 // class MemoryPool {
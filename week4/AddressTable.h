@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 주소 키 (AddressKey) → 값 을 찾는 평평한 해시 표 (열린 주소법, 선형 탐사)
+// 키와 값을 한 배열에 나란히 두므로 찾을 때 노드를 따라가지 않고 보통 캐시 라인 하나만 읽음
+// 값은 작은 것 (번호나 포인터) 만 넣음: 표가 커지거나 지울 때 칸이 옮겨지므로 값의 주소는 유지되지 않음
+template <typename V>
+class AddressTable {
+public:
+    explicit AddressTable(size_t initialCapacity = 64) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity * 2) {
+            capacity *= 2;
+        }
+        slots.resize(capacity);
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+    V* Find(uint64_t key) {
+        for (size_t i = Home(key);; i = (i + 1) & Mask()) {
+            Slot& slot = slots[i];
+            if (slot.key == key) {
+                return &slot.value;
+            }
+            if (slot.key == EMPTY) {
+                return nullptr;
+            }
+        }
+    }
+
+    // 없으면 value 로 넣고 true, 이미 있으면 바꾸지 않고 false
+    bool Insert(uint64_t key, const V& value) {
+        if ((count + 1) * 2 > slots.size()) {
+            Grow(); // 절반 넘게 차면 탐사가 길어지므로 두 배로
+        }
+        for (size_t i = Home(key);; i = (i + 1) & Mask()) {
+            Slot& slot = slots[i];
+            if (slot.key == key) {
+                return false;
+            }
+            if (slot.key == EMPTY) {
+                slot.key = key;
+                slot.value = value;
+                count++;
+                return true;
+            }
+        }
+    }
+
+    // 지운 자리 뒤에 이어진 칸들을 앞으로 당겨서 무덤 표시 없이 탐사가 끊기지 않게 함
+    bool Erase(uint64_t key) {
+        size_t i = Home(key);
+        while (slots[i].key != key) {
+            if (slots[i].key == EMPTY) {
+                return false;
+            }
+            i = (i + 1) & Mask();
+        }
+        count--;
+
+        size_t hole = i;
+        for (size_t j = (hole + 1) & Mask(); slots[j].key != EMPTY; j = (j + 1) & Mask()) {
+            // j 의 원래 자리가 hole 과 j 사이 (순환) 에 있지 않으면 hole 로 옮겨도 찾을 수 있음
+            size_t home = Home(slots[j].key);
+            if (((j - home) & Mask()) >= ((j - hole) & Mask())) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole].key = EMPTY;
+        return true;
+    }
+
+private:
+    // AddressKey 는 아래 48비트만 쓰므로 이 값이 실제 키가 될 수 없음
+    static constexpr uint64_t EMPTY = ~0ull;
+
+    struct Slot {
+        uint64_t key = EMPTY;
+        V value{};
+    };
+
+    std::vector<Slot> slots; // 크기는 항상 2의 거듭제곱
+    size_t count = 0;
+
+    size_t Mask() const {
+        return slots.size() - 1;
+    }
+
+    // 주소는 비슷한 값이 몰려 있으므로 곱셈으로 섞은 뒤 윗비트를 씀
+    size_t Home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & Mask();
+    }
+
+    void Grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        count = 0;
+        for (const Slot& slot : old) {
+            if (slot.key != EMPTY) {
+                Insert(slot.key, slot.value);
+            }
+        }
+    }
+};
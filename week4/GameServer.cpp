@@ -1,244 +1,698 @@
 #include <iostream>
 #include <WinSock2.h>
-#include <thread>
 #include <vector>
 #include <string>
-#include <sstream>
-#include <mutex>
+#include <array>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdlib>
+#include <timeapi.h>
+#include "Protocol.h"
+#include "UdpBatch.h"
+#include "RoomManager.h"
+#include "SpscQueue.h"
+#include "AddressTable.h"
 
 #pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "winmm.lib")
 
 constexpr int PORT = 12345;         // 포트번호는 12345
-constexpr int MAX_CLIENTS = 2;      // 최대 클라이언트 수는 2명 (1vs1 대전을 생각하였기에)
-constexpr int BUFFER_SIZE = 1024;
-
-struct PlayerInfo {
-    float x;
-    float y;
-    bool isAttacking;
-    bool isHit;
-    int health;
-    bool isRolling;
+constexpr int DEFAULT_ROOM_SIZE = 2;  // 방 하나의 정원 (1vs1 대전, 실행 인자로 바꿀 수 있음, 예: GameServer.exe 30 4)
+constexpr int DEFAULT_TICK_RATE = 30; // 초당 스냅샷 전송 횟수 (실행 인자로 바꿀 수 있음, 예: GameServer.exe 60)
+constexpr float DEFAULT_INTEREST_CELL_SIZE = 0.0f; // 관심 영역 격자 칸 크기 (0 이면 방의 모두가 모두를 받음, 실행 인자로 바꿀 수 있음, 예: GameServer.exe 30 64 3 20)
+constexpr uint64_t SESSION_TIMEOUT_MS = 30000; // 시작한 방에서 이 시간 동안 아무것도 보내지 않으면 나간 것으로 봄
+constexpr size_t INBOUND_QUEUE_SIZE = 4096;   // 워커마다 아직 처리하지 않은 받은 데이터그램을 담아 둘 수 있는 수
+constexpr size_t RELEASE_QUEUE_SIZE = 256;    // 워커마다 네트워크 스레드가 아직 지우지 않은 경로를 담아 둘 수 있는 수 (넘치면 워커가 들고 있다가 다시 넣음)
+constexpr bool LOG_MESSAGES = false; // 받은 텍스트 메시지와 매칭을 모두 콘솔에 출력 (디버깅용, 메시지마다 콘솔 출력을 하므로 느림)
+
+// 네트워크 스레드 → 워커: 받은 데이터그램
+struct InboundPacket {
+    sockaddr_in address;
+    uint32_t joinRoom;           // 처음 보는 주소면 넣을 방 번호 (네트워크 스레드가 정함), 아니면 0
+    uint16_t size;
+    char data[MAX_MESSAGE_SIZE]; // 클라이언트가 보내는 메시지는 모두 이 안에 들어감 (더 긴 데이터그램은 네트워크 스레드에서 버림)
 };
 
-struct ClientData {
-    sockaddr_in address;
-    PlayerInfo playerInfo;
-    int playerNumber;
-    bool isAlive;
+// 워커가 데이터그램을 보내는 곳 (워커 스레드에서만 사용)
+// 데이터그램은 워커가 같은 소켓으로 직접 보내므로 보내기도 워커 수만큼 나뉘고, 네트워크 스레드로는 세션이 없어진 주소 (지울 경로) 만 넘김
+class Outbox {
+public:
+    Outbox(UdpSender sender, SpscQueue<sockaddr_in, RELEASE_QUEUE_SIZE>& released, HANDLE ioWake) : sender(sender), released(released), ioWake(ioWake) {}
+
+    // 바로 보냄 (보내지 못하면 버림, UDP 이므로 다음 틱의 상태가 곧 다시 감)
+    void Send(const sockaddr_in& to, const char* data, size_t size) {
+        sender.Send(to, data, size);
+    }
+
+    // 경로 삭제는 버리면 그 주소가 다시 매칭되지 못하므로, 큐가 꽉 찼으면 들고 있다가 Commit 때 다시 넣음
+    void Forget(const sockaddr_in& address) {
+        pendingForgets.push_back(address);
+    }
+
+    // 지울 경로를 넣었으면 네트워크 스레드를 깨움 (워커 루프 한 바퀴에 한 번)
+    void Commit() {
+        bool pushed = false;
+        while (!pendingForgets.empty()) {
+            sockaddr_in* address = released.BeginPush();
+            if (address == nullptr) {
+                break;
+            }
+            *address = pendingForgets.back();
+            released.EndPush();
+            pendingForgets.pop_back();
+            pushed = true;
+        }
+        if (pushed) {
+            SetEvent(ioWake);
+        }
+    }
+
+private:
+    UdpSender sender;
+    SpscQueue<sockaddr_in, RELEASE_QUEUE_SIZE>& released;
+    HANDLE ioWake;
+    std::vector<sockaddr_in> pendingForgets;
 };
 
-std::vector<ClientData> clients;
-std::mutex clientsMutex;
-bool gameStarted = false;
+// 클라이언트 한 명에게 그 클라이언트의 형식으로 메시지를 보냄
+// text 가 있으면 텍스트 클라이언트에게는 인코딩하지 않고 그대로 보냄 (받은 텍스트 메시지를 그대로 중계할 때)
+void SendToClient(const Message& message, ClientData& client, Outbox& outbox, const char* text = nullptr, size_t textSize = 0) {
+    char packet[MAX_MESSAGE_SIZE];
+    size_t packetSize;
+    if (client.binaryProtocol) {
+        Message numbered = message;
+        numbered.sequence = client.sendSequence++;
+        packetSize = EncodeBinary(numbered, packet, sizeof(packet));
+        text = packet;
+    }
+    else if (text == nullptr) {
+        packetSize = EncodeText(message, packet, sizeof(packet));
+        text = packet;
+    }
+    else {
+        packetSize = textSize;
+    }
+
+    if (packetSize > 0) {
+        outbox.Send(client.address, text, packetSize);
+    }
+}
 
-// 플레이어의 상태를 클라이언트에게 브로드캐스팅하는 함수
-void BroadcastPlayerState(const PlayerInfo& playerInfo, SOCKET serverSocket = INVALID_SOCKET) {
-    std::string message = "PlayerState|" +
-                          std::to_string(playerInfo.x) + "|" +
-                          std::to_string(playerInfo.y) + "|" +
-                          (playerInfo.isAttacking ? "1" : "0") + "|" +
-                          (playerInfo.isHit ? "1" : "0") + "|" +
-                          std::to_string(playerInfo.health) + "|" +
-                          (playerInfo.isRolling ? "1" : "0");
+// 방의 모든 클라이언트에게 각자의 형식으로 메시지를 보냄
+void BroadcastMessage(const Message& message, Room& room, Outbox& outbox) {
+    for (ClientData* client : room.players) {
+        SendToClient(message, *client, outbox);
+    }
+}
 
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    for (const auto& client : clients) {
-        sendto(serverSocket, message.c_str(), message.size(), 0, reinterpret_cast<const sockaddr*>(&client.address), sizeof(client.address));
+// player 가 지난 틱 이후 바뀐 것을 텍스트 클라이언트 recipient 에게 예전 메시지로 보냄
+// (텍스트 형식은 메시지 하나에 한 가지만 담을 수 있으므로 바뀐 종류마다 하나씩)
+void SendTextState(const ClientData& player, ClientData& recipient, Outbox& outbox) {
+    Message message;
+    message.playerNumber = player.playerNumber;
+    message.player = player.playerInfo;
+    message.flipped = player.flipped;
+
+    if (player.changed & CHANGED_POSITION) {
+        message.type = MessageType::Position;
+        SendToClient(message, recipient, outbox, player.positionTextSize > 0 ? player.positionText : nullptr, player.positionTextSize);
+    }
+    if (player.changed & CHANGED_FLIP) {
+        message.type = MessageType::Flip;
+        SendToClient(message, recipient, outbox, player.flipTextSize > 0 ? player.flipText : nullptr, player.flipTextSize);
+    }
+    if (player.changed & CHANGED_STATE) {
+        message.type = MessageType::PlayerState;
+        SendToClient(message, recipient, outbox);
     }
 }
 
-std::vector<std::string> SplitString(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream(str);
-    while (std::getline(tokenStream, token, delimiter)) {
-        tokens.push_back(token);
+// 방의 지금 상태를 다음 순서 번호의 스냅샷으로 보관
+const SnapshotFrame& RecordSnapshot(Room& room) {
+    room.snapshotSequence++;
+    if (room.snapshotSequence == 0) {
+        room.snapshotSequence = 1; // 0 은 "아직 없음"
     }
-    return tokens;
+    SnapshotFrame& frame = room.history[room.snapshotSequence % SNAPSHOT_HISTORY];
+    frame.sequence = room.snapshotSequence;
+    frame.valid = true;
+    frame.states.clear();
+    for (const ClientData* player : room.players) {
+        frame.states.push_back(QuantizeState(player->playerNumber, player->playerInfo, player->flipped));
+    }
+    return frame;
 }
 
-// 클라이언트 핸들링 함수 (UDP) (핸들링은 멀티스레딩으로 처리)
-void ClientHandler(SOCKET serverSocket) {
-    char buffer[BUFFER_SIZE];
-    int bytesReceived;
-    sockaddr_in clientAddr;
-    int clientAddrSize = sizeof(clientAddr);
+// recipient 가 확인한 스냅샷이 아직 보관되어 있고 모든 플레이어의 상태를 담고 있으면 그 스냅샷 (아니면 nullptr → 전체 스냅샷)
+const SnapshotFrame* FindBaseline(const Room& room, const ClientData& recipient) {
+    if (!recipient.hasBaseline) {
+        return nullptr;
+    }
+    if (static_cast<uint16_t>(room.snapshotSequence - recipient.ackedSnapshot) >= SNAPSHOT_HISTORY) {
+        return nullptr;
+    }
+    const SnapshotFrame& frame = room.history[recipient.ackedSnapshot % SNAPSHOT_HISTORY];
+    if (!frame.valid || frame.sequence != recipient.ackedSnapshot || frame.states.size() != room.players.size()) {
+        return nullptr;
+    }
+    return &frame;
+}
 
-    while (true) {
-        bytesReceived = recvfrom(serverSocket, buffer, BUFFER_SIZE, 0, reinterpret_cast<sockaddr*>(&clientAddr), &clientAddrSize);
-        if (bytesReceived == SOCKET_ERROR || bytesReceived == 0) {
-            std::cerr << "Client disconnected\n";
-            break; // 스레드를 종료하고 나감
-        }
-
-        buffer[bytesReceived] = '\0';
-        std::cout << "Received from client: " << buffer << std::endl;
-
-        std::string message(buffer);
-
-        // 플레이어의 위치 메시지 처리
-        if (message.find("Player1Position") != std::string::npos || message.find("Player2Position") != std::string::npos) {
-            std::cout << "Received position update: " << message << std::endl;
-            // 위치 정보 추출 (토큰화를 하면 플레이어 번호와 위치 정보가 나눠짐)
-            std::vector<std::string> tokens = SplitString(message, '|');
-            if (tokens.size() == 2) { // 메시지가 올바른 형식인지 확인
-                // 플레이어 번호 추출 (1p 인지 2p 인지 확인하기 위함)
-                int playerNumber = (message[6] == '1') ? 1 : 2;
-                // 위치 정보 추출
-                std::string positionInfo = tokens[1];
-                // 모든 클라이언트에게 위치 정보 브로드캐스팅 (플레이어 번호와 위치 정보를 합쳐서 보냄)
-                std::lock_guard<std::mutex> lock(clientsMutex);
-                for (const auto& client : clients) {
-                    sendto(serverSocket, buffer, bytesReceived, 0, reinterpret_cast<const sockaddr*>(&client.address), sizeof(client.address));
-                }
+// 관심 영역을 쓰는 방에서, 움직인 플레이어만 격자에서 옮기고 클라이언트마다 보이는 플레이어를 다시 구함
+// (플레이어마다 둘레 칸만 보므로 방 전체로는 인원 × 근처 인원)
+void UpdateInterest(Room& room, const SnapshotFrame& latest) {
+    SpatialGrid& grid = *room.grid;
+    for (size_t i = 0; i < room.players.size(); i++) {
+        const ClientData& player = *room.players[i];
+        if (player.changed & (CHANGED_POSITION | CHANGED_STATE)) {
+            grid.Update(static_cast<uint16_t>(i), player.playerInfo.x, player.playerInfo.y);
+        }
+    }
+    std::vector<uint16_t> nearby;
+    for (ClientData* client : room.players) {
+        nearby.clear();
+        grid.ForEachNear(client->playerInfo.x, client->playerInfo.y, [&](uint16_t slot) {
+            nearby.push_back(slot);
+        });
+        client->interest.Update(nearby, latest.sequence, room.players.size());
+    }
+}
+
+// 지난 틱 이후 상태가 바뀐 방의 플레이어들을 모아서 그 방의 클라이언트마다 한 번씩 보냄
+// 바이너리 클라이언트에게는 스냅샷 데이터그램 하나로 보내므로, 입력이 얼마나 자주 오든 송신량은 틱 수 × 클라이언트 수를 넘지 않음
+// 확인 번호를 보내는 클라이언트에게는 확인한 스냅샷에서 바뀐 필드만 보내고 (기준이 없으면 전체), 최신 상태를 확인할 때까지 틱마다 다시 보냄
+// 그래서 데이터그램 하나를 잃어도 다음 틱의 델타가 그만큼을 같이 담아서 가고, 변화가 없는 방은 모두 확인한 뒤로 아무것도 보내지 않음
+// 관심 영역을 쓰는 방에서는 클라이언트마다 자기 둘레의 플레이어만 보냄
+void SendSnapshot(Room& room, RoomManager& rooms, Outbox& outbox) {
+    bool changed = false;
+    for (const ClientData* client : room.players) {
+        changed |= client->changed != 0;
+    }
+    if (!changed && room.snapshotSequence == 0) {
+        return;
+    }
+    const SnapshotFrame& latest = changed ? RecordSnapshot(room) : room.history[room.snapshotSequence % SNAPSHOT_HISTORY];
+    size_t playerCount = latest.states.size();
+    if (room.grid && changed) {
+        UpdateInterest(room, latest);
+    }
+
+    char packet[MAX_SNAPSHOT_SIZE];
+    uint16_t visible[MAX_SNAPSHOT_PLAYERS]; // 이 클라이언트에게 보이는 플레이어의 자리 번호
+    SnapshotState from[MAX_SNAPSHOT_PLAYERS];
+    SnapshotState to[MAX_SNAPSHOT_PLAYERS];
+    bool unsettled = false; // 최신 상태를 아직 확인하지 않은 클라이언트가 있는지
+    for (ClientData* client : room.players) {
+        ClientData& recipient = *client;
+        size_t visibleCount = 0;
+        if (room.grid) {
+            for (uint16_t slot : recipient.interest.Visible()) {
+                visible[visibleCount++] = slot;
             }
         }
-        // 클라이언트의 flip 메시지 처리 find로 Player1Flipped 형식으로
-        else if (message.find("Player1Flipped") != std::string::npos || message.find("Player2Flipped") != std::string::npos) {
-            // 모든 클라이언트에게 flip 메시지 브로드캐스팅
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            for (const auto& client : clients) {
-                sendto(serverSocket, buffer, bytesReceived, 0, reinterpret_cast<const sockaddr*>(&client.address), sizeof(client.address));
+        else {
+            for (size_t i = 0; i < playerCount; i++) {
+                visible[visibleCount++] = static_cast<uint16_t>(i);
             }
         }
 
-        // 클라이언트로부터 받은 메시지를 처리
-        else if (message.substr(0, 12) == "PlayerUpdate") {
-            std::vector<std::string> tokens = SplitString(message, '|');
-            if (tokens.size() == 7) {
-                PlayerInfo playerInfo;
-                playerInfo.x = std::stof(tokens[1]);
-                playerInfo.y = std::stof(tokens[2]);
-                playerInfo.isAttacking = tokens[3] == "1";
-                playerInfo.isHit = tokens[4] == "1";
-                playerInfo.health = std::stoi(tokens[5]);
-                playerInfo.isRolling = tokens[6] == "1";
+        if (!recipient.binaryProtocol) {
+            if (changed) {
+                for (size_t i = 0; i < visibleCount; i++) {
+                    const ClientData* player = room.players[visible[i]];
+                    if (player->changed != 0) {
+                        SendTextState(*player, recipient, outbox);
+                    }
+                }
+            }
+            continue;
+        }
 
-                BroadcastPlayerState(playerInfo, serverSocket);
+        size_t packetSize = 0;
+        if (!recipient.ackMode) {
+            // 확인 번호를 보내지 않는 클라이언트: 바뀐 플레이어만 담은 전체 스냅샷
+            if (!changed) {
+                continue;
             }
+            size_t count = 0;
+            for (size_t i = 0; i < visibleCount; i++) {
+                if (room.players[visible[i]]->changed != 0) {
+                    to[count++] = latest.states[visible[i]];
+                }
+            }
+            packetSize = EncodeSnapshot(latest.sequence, to, count, packet, sizeof(packet));
+        }
+        else if (recipient.hasBaseline && recipient.ackedSnapshot == latest.sequence) {
+            continue; // 이미 최신 상태를 갖고 있음
         }
-        // 클라이언트가 죽었음을 알림 
-        else if (message.substr(0, 10) == "Player1Dead" || message.substr(0, 10) == "Player2Dead") {
-            // 게임 종료
-            gameStarted = false;
-            std::string endGameMessage = "EndGame";
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            for (const auto& client : clients) {
-                sendto(serverSocket, endGameMessage.c_str(), endGameMessage.size(), 0, reinterpret_cast<const sockaddr*>(&client.address), sizeof(client.address));
+        else {
+            if (const SnapshotFrame* baseline = FindBaseline(room, recipient)) {
+                size_t changedPlayers = 0;
+                if (room.grid) {
+                    // 기준 스냅샷에 없던 플레이어는 모든 필드를, 사라진 플레이어는 지움 표시를 보냄
+                    uint8_t removed[MAX_SNAPSHOT_PLAYERS];
+                    size_t removedCount = 0;
+                    recipient.interest.Confirm(recipient.ackedSnapshot, [&](uint16_t slot) {
+                        if (removedCount < MAX_SNAPSHOT_PLAYERS) {
+                            removed[removedCount++] = latest.states[slot].playerNumber;
+                        }
+                    });
+                    for (size_t i = 0; i < visibleCount; i++) {
+                        uint16_t slot = visible[i];
+                        from[i] = recipient.interest.Known(slot) ? baseline->states[slot] : SnapshotState();
+                        to[i] = latest.states[slot];
+                    }
+                    packetSize = EncodeDeltaSnapshot(latest.sequence, baseline->sequence, from, to, visibleCount, removed, removedCount,
+                                                     packet, sizeof(packet), changedPlayers);
+                }
+                else {
+                    packetSize = EncodeDeltaSnapshot(latest.sequence, baseline->sequence, baseline->states.data(), latest.states.data(), playerCount,
+                                                     nullptr, 0, packet, sizeof(packet), changedPlayers);
+                }
+                if (packetSize > 0 && changedPlayers == 0) {
+                    continue; // 기준과 최신 상태가 같음
+                }
+            }
+            // 기준이 없거나, 델타가 데이터그램 하나에 들어가지 않으면 (플레이어마다 최대 9바이트라 8바이트인 전체 항목보다 클 수 있음) 전체 스냅샷
+            if (packetSize == 0) {
+                for (size_t i = 0; i < visibleCount; i++) {
+                    to[i] = latest.states[visible[i]];
+                }
+                packetSize = EncodeSnapshot(latest.sequence, to, visibleCount, packet, sizeof(packet));
+                if (!recipient.sentFullSnapshot) {
+                    recipient.sentFullSnapshot = true;
+                    recipient.fullSnapshot = latest.sequence;
+                }
             }
+            unsettled = true;
         }
-        else if (message.substr(0, 11) == "GameStarted") {
-            gameStarted = true;
+        if (packetSize > 0) {
+            outbox.Send(recipient.address, packet, packetSize);
         }
-        // 게임이 종료되었음을 알림 (시간이 종료되어서 끝난 경우)
-        else if (message.substr(0, 8) == "GameOver") {
-            gameStarted = false;
+    }
+
+    for (ClientData* client : room.players) {
+        client->changed = 0;
+    }
+    if (unsettled) {
+        rooms.MarkDirty(room);
+    }
+}
+
+// 클라이언트가 보낸 스냅샷 확인 번호를 반영 (처음 받으면 그 클라이언트는 델타 스냅샷을 받기 시작함)
+void AcceptSnapshotAck(ClientData& sender, uint16_t ack, RoomManager& rooms) {
+    Room& room = *sender.room;
+    if (room.snapshotSequence == 0 || IsNewerSequence(ack, room.snapshotSequence)) {
+        return; // 아직 보내지 않은 번호
+    }
+    if (sender.ackMode && !IsNewerSequence(ack, sender.ackedSnapshot)) {
+        return; // 늦게 도착한 옛 확인
+    }
+    sender.ackedSnapshot = ack;
+    if (sender.sentFullSnapshot && !IsNewerSequence(sender.fullSnapshot, ack)) {
+        sender.hasBaseline = true;
+    }
+    if (!sender.ackMode) {
+        sender.ackMode = true;
+        rooms.MarkDirty(room); // 다음 틱에 전체 스냅샷을 보냄
+    }
+}
+
+// 메시지를 처리할 때 필요한 것들
+struct ReceivedMessage {
+    Message message;
+    ClientData* sender;    // 보낸 클라이언트
+    const char* text;      // 텍스트 메시지면 받은 그대로의 내용 (바이너리면 nullptr)
+    size_t textSize;
+    Outbox* outbox;
+    RoomManager* rooms;
+};
+
+// 메시지 종류별 처리 함수
+using MessageHandler = void (*)(ReceivedMessage& received);
+
+// 텍스트로 받은 메시지를 틱에서 그대로 중계할 수 있도록 보관 (바이너리로 받았거나 너무 길면 크기 0 → 틱에서 새로 인코딩)
+// 보낸 사람은 주소로 찾은 세션으로 정해지므로, 메시지 안의 플레이어 번호가 그 세션과 다르면 그대로 중계하지 않고 세션의 번호로 새로 인코딩
+void KeepText(const ReceivedMessage& received, char* out, size_t& outSize) {
+    outSize = 0;
+    bool sameSender = received.message.playerNumber == received.sender->playerNumber;
+    if (received.text != nullptr && sameSender && received.textSize <= MAX_MESSAGE_SIZE) {
+        std::memcpy(out, received.text, received.textSize);
+        outSize = received.textSize;
+    }
+}
+
+// 위치, flip, 상태는 바로 보내지 않고 최신 값만 남겨 두었다가 다음 틱에 보냄
+void HandlePosition(ReceivedMessage& received) {
+    ClientData& sender = *received.sender;
+    sender.playerInfo.x = received.message.player.x;
+    sender.playerInfo.y = received.message.player.y;
+    received.rooms->MarkChanged(sender, CHANGED_POSITION);
+    KeepText(received, sender.positionText, sender.positionTextSize);
+}
+
+void HandleFlip(ReceivedMessage& received) {
+    ClientData& sender = *received.sender;
+    sender.flipped = received.message.flipped;
+    received.rooms->MarkChanged(sender, CHANGED_FLIP);
+    KeepText(received, sender.flipText, sender.flipTextSize);
+}
+
+void HandlePlayerState(ReceivedMessage& received) {
+    ClientData& sender = *received.sender;
+    sender.playerInfo = received.message.player;
+    received.rooms->MarkChanged(sender, CHANGED_STATE);
+}
+
+// 클라이언트가 죽었음을 알림 → 게임 종료 (드문 이벤트는 틱을 기다리지 않고 바로 보냄)
+void HandleDead(ReceivedMessage& received) {
+    Room& room = *received.sender->room;
+    room.gameStarted = false;
+    Message endGame;
+    endGame.type = MessageType::EndGame;
+    BroadcastMessage(endGame, room, *received.outbox);
+}
+
+void HandleGameStarted(ReceivedMessage& received) {
+    received.sender->room->gameStarted = true;
+}
+
+// 게임이 종료되었음을 알림 (시간이 종료되어서 끝난 경우)
+void HandleGameOver(ReceivedMessage& received) {
+    received.sender->room->gameStarted = false;
+}
+
+// 메시지 종류를 번호로 바로 찾는 처리 함수 표 (처리하지 않는 종류는 nullptr)
+const std::array<MessageHandler, static_cast<size_t>(MessageType::Count)> messageHandlers = [] {
+    std::array<MessageHandler, static_cast<size_t>(MessageType::Count)> handlers{};
+    handlers[static_cast<size_t>(MessageType::Position)] = HandlePosition;
+    handlers[static_cast<size_t>(MessageType::Flip)] = HandleFlip;
+    handlers[static_cast<size_t>(MessageType::PlayerState)] = HandlePlayerState;
+    handlers[static_cast<size_t>(MessageType::Dead)] = HandleDead;
+    handlers[static_cast<size_t>(MessageType::GameStarted)] = HandleGameStarted;
+    handlers[static_cast<size_t>(MessageType::GameOver)] = HandleGameOver;
+    return handlers;
+}();
+
+// 참가한 클라이언트가 보낸 데이터그램 하나를 처리
+// 바이너리와 텍스트 메시지를 모두 받은 버퍼에서 바로 Message 로 디코딩하고 (힙 할당 없음), 종류별 처리 함수 표로 처리
+// 받는 클라이언트마다 그 클라이언트의 형식으로 보냄
+void HandleMessage(const InboundPacket& packet, ClientData& sender, RoomManager& rooms, Outbox& outbox) {
+    ReceivedMessage received;
+    bool isText = !IsBinaryMessage(packet.data, packet.size);
+    if (LOG_MESSAGES && isText) {
+        std::cout << "Received from client: ";
+        std::cout.write(packet.data, packet.size) << std::endl;
+    }
+    if (!DecodeMessage(packet.data, packet.size, received.message)) {
+        return; // 모르는 메시지나 깨진 메시지는 버림
+    }
+    if (received.message.hasAck) {
+        AcceptSnapshotAck(sender, received.message.ack, rooms);
+    }
+    MessageHandler handler = messageHandlers[static_cast<size_t>(received.message.type)];
+    if (handler == nullptr) {
+        return;
+    }
+    received.sender = &sender;
+    received.text = isText ? packet.data : nullptr;
+    received.textSize = packet.size;
+    received.outbox = &outbox;
+    received.rooms = &rooms;
+
+    // 바이너리 상태 메시지는 순서 번호로 늦게 도착한 옛 상태를 버림 (UDP 는 순서를 보장하지 않음)
+    MessageType type = received.message.type;
+    bool isState = type == MessageType::Position || type == MessageType::Flip || type == MessageType::PlayerState;
+    if (!isText && isState) {
+        if (sender.hasSequence && !IsNewerSequence(received.message.sequence, sender.lastSequence)) {
+            return;
         }
+        sender.lastSequence = received.message.sequence;
+        sender.hasSequence = true;
     }
+
+    handler(received);
 }
 
 // 클라이언트에게 환영 메시지를 보내는 함수
-void SendWelcomeMessage(const sockaddr_in& clientAddr, SOCKET serverSocket) {
+void SendWelcomeMessage(const sockaddr_in& clientAddr, Outbox& outbox) {
     std::string welcomeMessage = "Welcome to the game server!";
-    sendto(serverSocket, welcomeMessage.c_str(), welcomeMessage.size(), 0, reinterpret_cast<const sockaddr*>(&clientAddr), sizeof(clientAddr));
-}
-
-// 클라이언트에게 플레이어 번호를 할당하고, 게임 시작 여부를 확인하는 함수
-void AssignPlayerNumber(const sockaddr_in& clientAddr, SOCKET serverSocket) {
-    // 클라이언트가 연결되면 클라이언트의 수를 증가시키고, 클라이언트에게 플레이어 번호를 할당
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    // 클라이언트의 수가 최대 클라이언트 수보다 작을 때만 클라이언트를 추가
-    if (clients.size() < MAX_CLIENTS) {
-        // 이미 연결된 클라이언트인지 확인
-        bool alreadyConnected = false;
-        for (const auto& client : clients) {
-            if (client.address.sin_addr.s_addr == clientAddr.sin_addr.s_addr && client.address.sin_port == clientAddr.sin_port) {
-                alreadyConnected = true;
-                break;
-            }
-        }
-        if (!alreadyConnected) {
-            int playerNumber = clients.size() + 1;
-            ClientData clientData;
-            clientData.address = clientAddr;
-            clientData.playerNumber = playerNumber;
-            clientData.isAlive = true;  // 새로운 클라이언트는 살아있음
-            clients.push_back(clientData);
+    outbox.Send(clientAddr, welcomeMessage.c_str(), welcomeMessage.size());
+}
+
+// 새 클라이언트를 roomId 번 방에 넣고 플레이어 번호를 알려줌, 그 방의 정원이 차면 게임 시작
+// binaryProtocol 은 클라이언트가 처음 보낸 메시지가 바이너리였는지 (이후 이 클라이언트와는 그 형식으로 주고받음)
+void AssignPlayerNumber(const sockaddr_in& clientAddr, uint32_t roomId, bool binaryProtocol, uint64_t nowMs, RoomManager& rooms, Outbox& outbox) {
+    ClientData& client = rooms.Join(clientAddr, roomId, binaryProtocol, nowMs);
+    Room& room = *client.room;
+
+    // 환영 메시지 보내기 (바이너리 클라이언트는 Welcome 메시지 하나에 플레이어 번호까지 담아 보냄)
+    if (!binaryProtocol) {
+        SendWelcomeMessage(clientAddr, outbox);
+    }
+
+    // 플레이어 번호 메시지 보내기
+    Message welcome;
+    welcome.type = MessageType::Welcome;
+    welcome.playerNumber = client.playerNumber;
+    SendToClient(welcome, client, outbox);
+
+    if (LOG_MESSAGES) {
+        std::cout << "Assigned player number " << client.playerNumber << " in room " << room.id << " (" << rooms.SessionCount() << " clients, " << rooms.RoomCount() << " rooms)\n";
+    }
+
+    // 방의 정원이 차면 게임 시작
+    if (room.matched) {
+        Message startGame;
+        startGame.type = MessageType::StartGame;
+        BroadcastMessage(startGame, room, outbox);
+    }
+}
 
-            // 클라이언트의 데이터 한번 출력
-            std::cout << clients.size() << " clients connected\n";
+// 방 여러 개를 맡아서 처리하는 워커 스레드
+// 방 하나는 처음부터 끝까지 한 워커에만 있으므로 패킷을 처리할 때 락을 잡지 않음
+// 네트워크 스레드가 inbound 에 넣어 준 데이터그램을 처리하고, 자기 틱마다 스냅샷을 만들어 sender 로 직접 보냄
+// 세션이 없어진 주소는 released 로 네트워크 스레드에 알려 경로를 지우게 함
+class Worker {
+public:
+    SpscQueue<InboundPacket, INBOUND_QUEUE_SIZE> inbound;
+    SpscQueue<sockaddr_in, RELEASE_QUEUE_SIZE> released;
 
-            // 환영 메시지 보내기
-            SendWelcomeMessage(clientAddr, serverSocket);
+    Worker(size_t roomSize, float interestCellSize, int tickRate, UdpSender sender, HANDLE ioWake)
+        : rooms(roomSize, interestCellSize), tickInterval(1000000 / tickRate), outbox(sender, released, ioWake), wake(CreateEvent(nullptr, FALSE, FALSE, nullptr)) {}
 
-            // 플레이어 번호 메시지 보내기
-            std::string playerNumberMessage = std::to_string(playerNumber);
-            sendto(serverSocket, playerNumberMessage.c_str(), playerNumberMessage.size(), 0, reinterpret_cast<const sockaddr*>(&clientAddr), sizeof(clientAddr));
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
 
-            std::cout << "Assigned player number " << playerNumber << " to client\n";
+    ~Worker() {
+        CloseHandle(wake);
+    }
+
+    void Start() {
+        thread = std::thread(&Worker::Run, this);
+    }
+
+    void Join() {
+        thread.join();
+    }
+
+    // inbound 에 넣은 뒤 네트워크 스레드가 호출
+    void Wake() {
+        SetEvent(wake);
+    }
 
-            // 게임 시작 여부를 확인하고, 두 명의 클라이언트가 연결되었을 경우 게임 시작
-            if (clients.size() == MAX_CLIENTS && !gameStarted) {
-                std::string startGameMessage = "StartGame";
-                for (const auto& client : clients) {
-                    sendto(serverSocket, startGameMessage.c_str(), startGameMessage.size(), 0, reinterpret_cast<const sockaddr*>(&client.address), sizeof(client.address));
+private:
+    RoomManager rooms;
+    std::chrono::microseconds tickInterval;
+    Outbox outbox;
+    HANDLE wake;
+    std::thread thread;
+
+    void Run() {
+        auto nextTick = std::chrono::steady_clock::now() + tickInterval;
+        uint64_t nextIdleCheckMs = GetTickCount64() + 1000;
+        while (true) {
+            // 다음 틱까지 데이터그램이 들어오기를 기다림
+            auto now = std::chrono::steady_clock::now();
+            if (now < nextTick) {
+                WaitForSingleObject(wake, static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now + std::chrono::microseconds(999)).count()));
+            }
+
+            uint64_t nowMs = GetTickCount64();
+            while (InboundPacket* packet = inbound.Front()) {
+                Handle(*packet, nowMs);
+                inbound.Pop();
+            }
+
+            // 상대가 나간 방은 닫고 남은 플레이어에게 게임 종료를 알림
+            if (nowMs >= nextIdleCheckMs) {
+                nextIdleCheckMs = nowMs + 1000;
+                rooms.RemoveIdle(nowMs, SESSION_TIMEOUT_MS, [&](ClientData& player, bool idle) {
+                    if (!idle) {
+                        Message endGame;
+                        endGame.type = MessageType::EndGame;
+                        SendToClient(endGame, player, outbox);
+                    }
+                    outbox.Forget(player.address);
+                });
+            }
+
+            now = std::chrono::steady_clock::now();
+            if (now >= nextTick) {
+                rooms.ForEachDirtyRoom([&](Room& room) {
+                    SendSnapshot(room, rooms, outbox);
+                });
+                nextTick += tickInterval;
+                if (nextTick <= now) {
+                    nextTick = now + tickInterval; // 많이 밀렸으면 놓친 틱을 몰아서 보내지 않음
                 }
-                std::thread clientHandlerThread(ClientHandler, serverSocket);
-                clientHandlerThread.detach(); // detach() 호출하여 메인 스레드가 클라이언트 핸들러 스레드를 기다리지 않도록 함
             }
+            outbox.Commit();
         }
     }
-}
 
-int main() {
+    void Handle(const InboundPacket& packet, uint64_t nowMs) {
+        ClientData* sender = rooms.Find(packet.address);
+        if (sender != nullptr) {
+            sender->lastReceivedMs = nowMs;
+            HandleMessage(packet, *sender, rooms, outbox);
+        }
+        else if (packet.joinRoom != 0) {
+            AssignPlayerNumber(packet.address, packet.joinRoom, IsBinaryMessage(packet.data, packet.size), nowMs, rooms, outbox);
+        }
+        // 그 외에는 방금 닫힌 세션에서 온 것이므로 버림 (경로가 지워진 뒤에 오는 데이터그램은 새로 매칭됨)
+    }
+};
+
+int main(int argc, char* argv[]) {
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
         std::cerr << "Failed to initialize Winsock\n";
         return -1;
     }
 
-    SOCKET serverSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (serverSocket == INVALID_SOCKET) {
-        std::cerr << "Failed to create socket\n";
+    // 받기는 main 스레드가 이 소켓 하나로 묶어서 처리하고, 게임 처리와 보내기는 워커들이 같은 소켓으로 나눠서 함
+    // (Windows 에는 UDP 를 소켓 여러 개에 나눠 주는 SO_REUSEPORT 가 없으므로 받는 스레드 하나가 워커에게 나눠 줌)
+    UdpBatch network;
+    if (!network.Open(PORT)) {
+        std::cerr << "Failed to bind\n";
         WSACleanup();
         return -1;
     }
 
-    sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = htonl(INADDR_ANY);
-    serverAddr.sin_port = htons(PORT);
+    int tickRate = argc > 1 ? std::atoi(argv[1]) : DEFAULT_TICK_RATE;
+    if (tickRate <= 0 || tickRate > 1000) {
+        tickRate = DEFAULT_TICK_RATE;
+    }
+    int roomSize = argc > 2 ? std::atoi(argv[2]) : DEFAULT_ROOM_SIZE;
+    if (roomSize < 2 || roomSize > static_cast<int>(MAX_SNAPSHOT_PLAYERS)) {
+        roomSize = DEFAULT_ROOM_SIZE;
+    }
+    // 예전 텍스트 형식은 Player1, Player2 만 나타낼 수 있으므로 (PlayerState 는 번호도 없음) 정원이 2명보다 크면 텍스트 클라이언트를 받지 않음
+    bool acceptTextClients = roomSize <= 2;
+    // 워커 수 (기본: 코어 수 - 1, 네트워크 스레드 몫 하나를 뺌)
+    int workerCount = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    // 관심 영역 격자 칸 크기 (이 거리 안의 플레이어는 항상 받고, 두 배 넘게 떨어진 플레이어는 받지 않음)
+    float interestCellSize = argc > 4 ? static_cast<float>(std::atof(argv[4])) : DEFAULT_INTEREST_CELL_SIZE;
+    if (!(interestCellSize > 0.0f)) {
+        interestCellSize = 0.0f;
+    }
+    timeBeginPeriod(1); // 대기 시간 해상도를 1ms 로 (기본 15.6ms 로는 60Hz 틱을 맞출 수 없음)
 
-    if (bind(serverSocket, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) == SOCKET_ERROR) {
-        std::cerr << "Failed to bind\n";
-        closesocket(serverSocket);
-        WSACleanup();
-        return -1;
+    HANDLE ioWake = CreateEvent(nullptr, FALSE, FALSE, nullptr); // 워커가 지울 경로를 넣으면 켬
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>(roomSize, interestCellSize, tickRate, network.Sender(), ioWake));
+        workers.back()->Start();
     }
 
-    std::cout << "Server started. Waiting for clients...\n";
+    std::cout << "Server started (" << (network.IsRegisteredIo() ? "registered I/O" : "recvfrom/sendto") << ", " << tickRate << " ticks/s, "
+              << roomSize << " players/room, " << workerCount << " workers, interest cell size " << interestCellSize << "). Waiting for clients...\n";
+    if (!acceptTextClients) {
+        std::cout << "Text protocol clients are refused (the text protocol only supports 2 players per room)\n";
+    }
 
+    // 주소 → 그 세션을 가진 워커
+    // 방 번호와 그 방을 맡을 워커는 이 스레드가 정함: 새 주소는 지금 채우는 방 번호와 함께 그 방의 워커로 보내고,
+    // 정원만큼 보냈으면 새 방 번호를 열고 다음 워커로 넘어감 (워커는 받은 번호의 방에 넣기만 하므로 방이 워커 사이에 갈라지지 않음)
+    AddressTable<uint32_t> routes(4096);
+    uint32_t nextRoomId = 1;
+    uint32_t fillingRoom = nextRoomId++;
+    uint32_t fillingWorker = 0;
+    int fillingCount = 0;
+    std::vector<bool> woken(workerCount);
+
+    UdpBatch::Datagram datagrams[UdpBatch::BATCH_SIZE];
     while (true) {
-        char buffer[BUFFER_SIZE];
-        sockaddr_in clientAddr;
-        int clientAddrSize = sizeof(clientAddr);
+        int count = network.Receive(datagrams, UdpBatch::BATCH_SIZE, 1000, ioWake);
+        for (int i = 0; i < count; i++) {
+            const UdpBatch::Datagram& datagram = datagrams[i];
+            if (datagram.size <= 0 || datagram.size > static_cast<int>(MAX_MESSAGE_SIZE)) {
+                continue;
+            }
 
-        int bytesReceived = recvfrom(serverSocket, buffer, BUFFER_SIZE, 0, reinterpret_cast<sockaddr*>(&clientAddr), &clientAddrSize);
-        if (bytesReceived == SOCKET_ERROR || bytesReceived == 0) {
-            std::cerr << "Failed to receive connection request from client\n";
-            continue;
-        }
+            uint64_t key = AddressKey(datagram.from);
+            bool join = false;
+            uint32_t* route = routes.Find(key);
+            uint32_t workerIndex = route != nullptr ? *route : fillingWorker;
+            if (route == nullptr) {
+                if (!acceptTextClients && !IsBinaryMessage(datagram.data, datagram.size)) {
+                    continue; // 방에 넣지 않고 버림 (경로도 만들지 않으므로 방의 정원을 세는 데 들어가지 않음)
+                }
+                routes.Insert(key, workerIndex);
+                join = true;
+            }
 
-        AssignPlayerNumber(clientAddr, serverSocket);
+            Worker& worker = *workers[workerIndex];
+            InboundPacket* packet = worker.inbound.BeginPush();
+            if (packet == nullptr) {
+                if (join) {
+                    routes.Erase(key); // 워커가 받지 못했으므로 다음 데이터그램 때 다시 매칭
+                }
+                continue; // 워커가 밀려 있으면 버림
+            }
+            packet->address = datagram.from;
+            packet->joinRoom = join ? fillingRoom : 0;
+            packet->size = static_cast<uint16_t>(datagram.size);
+            std::memcpy(packet->data, datagram.data, datagram.size);
+            worker.inbound.EndPush();
+            woken[workerIndex] = true;
+
+            if (join && ++fillingCount == roomSize) {
+                fillingCount = 0;
+                fillingRoom = nextRoomId++;
+                if (fillingRoom == 0) {
+                    fillingRoom = nextRoomId++; // 0 은 "참가 아님"
+                }
+                fillingWorker = (fillingWorker + 1) % workerCount;
+            }
+        }
+        for (int i = 0; i < workerCount; i++) {
+            if (woken[i]) {
+                workers[i]->Wake();
+                woken[i] = false;
+            }
+        }
 
-        if (clients.size() >= MAX_CLIENTS) {
-            // 최대 클라이언트 수에 도달하면 서버를 종료하지 않고 계속 대기합니다.
-            std::cout << "Maximum number of clients reached. Waiting for more clients...\n";
+        // 워커들이 알려 준, 세션이 없어진 주소의 경로를 지움 (그 주소의 다음 데이터그램은 새로 매칭됨)
+        for (auto& worker : workers) {
+            while (sockaddr_in* address = worker->released.Front()) {
+                routes.Erase(AddressKey(*address));
+                worker->released.Pop();
+            }
         }
     }
 
-    closesocket(serverSocket);
+    for (auto& worker : workers) {
+        worker->Join();
+    }
+    CloseHandle(ioWake);
+    timeEndPeriod(1);
+    network.Close();
     WSACleanup();
     return 0;
 }
@@ -0,0 +1,654 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <charconv>
+
+// 게임 서버와 클라이언트가 주고받는 메시지
+// 바이너리 메시지는 고정된 배치로 인코딩하고, 예전 텍스트 메시지 ("PlayerUpdate|x|y|...") 도 계속 받는다 (호환 모드)
+// 첫 바이트의 최상위 비트가 1 이면 바이너리, 0 이면 텍스트 (텍스트 메시지는 항상 ASCII 로 시작함)
+
+struct PlayerInfo {
+    float x;
+    float y;
+    bool isAttacking;
+    bool isHit;
+    int health;
+    bool isRolling;
+};
+
+// 메시지 종류 (바이너리 메시지의 첫 바이트는 0x80 | 종류)
+enum class MessageType : uint8_t {
+    None = 0,
+    Join,        // 클라이언트 → 서버: 접속 요청
+    Welcome,     // 서버 → 클라이언트: 환영 + 플레이어 번호
+    StartGame,   // 서버 → 클라이언트
+    EndGame,     // 서버 → 클라이언트
+    Position,    // 플레이어 위치
+    Flip,        // 플레이어가 바라보는 방향
+    PlayerState, // 플레이어 전체 상태 (클라이언트가 보내면 PlayerUpdate)
+    Dead,        // 클라이언트 → 서버: 플레이어가 죽음
+    GameStarted, // 클라이언트 → 서버
+    GameOver,    // 클라이언트 → 서버: 시간이 다 되어 게임이 끝남
+    Snapshot,    // 서버 → 클라이언트: 플레이어들의 상태 (전체)
+    Ack,         // 클라이언트 → 서버: 받은 스냅샷 확인만 보냄 (보낼 입력이 없을 때)
+    DeltaSnapshot, // 서버 → 클라이언트: 클라이언트가 확인한 스냅샷에서 바뀐 필드만
+    Count,
+};
+
+// 디코딩한 메시지 (바이너리와 텍스트 모두 이 형태로 다룸)
+struct Message {
+    MessageType type = MessageType::None;
+    uint16_t sequence = 0;  // 보낸 쪽이 메시지마다 1씩 늘리는 번호 (늦게 도착한 옛 상태를 버리는 데 사용)
+    int playerNumber = 0;   // Welcome, Position, Flip, PlayerState, Dead
+    PlayerInfo player = {}; // Position 은 x, y 만, PlayerState 는 전부
+    bool flipped = false;   // Flip
+    bool hasAck = false;    // 클라이언트 → 서버: 바이너리 메시지 끝에 붙은 확인 번호가 있는지
+    uint16_t ack = 0;       // 클라이언트가 마지막으로 받아서 적용한 스냅샷의 순서 번호
+};
+
+constexpr uint8_t BINARY_FLAG = 0x80;
+constexpr size_t BINARY_HEADER_SIZE = 3; // 종류 1 + 순서 번호 2
+constexpr size_t MAX_MESSAGE_SIZE = 128;  // 인코딩한 메시지의 최대 크기 (텍스트 포함)
+
+// 위치는 1/100 단위 16비트 정수로 보냄 (±327.67 까지, 넘으면 잘림)
+constexpr float POSITION_SCALE = 100.0f;
+
+inline int16_t QuantizePosition(float value) {
+    if (std::isnan(value)) {
+        return 0; // NaN 은 아래 비교가 모두 거짓이라 그대로 변환되면 정의되지 않은 동작
+    }
+    float scaled = std::round(value * POSITION_SCALE);
+    scaled = scaled < INT16_MIN ? INT16_MIN : scaled > INT16_MAX ? INT16_MAX : scaled;
+    return static_cast<int16_t>(scaled);
+}
+
+// 상태 비트
+constexpr uint8_t FLAG_ATTACKING = 1 << 0;
+constexpr uint8_t FLAG_HIT = 1 << 1;
+constexpr uint8_t FLAG_ROLLING = 1 << 2;
+constexpr uint8_t FLAG_FLIPPED = 1 << 3; // 스냅샷에서만 사용
+
+inline uint8_t PackFlags(const PlayerInfo& player, bool flipped = false) {
+    return (player.isAttacking ? FLAG_ATTACKING : 0) | (player.isHit ? FLAG_HIT : 0) | (player.isRolling ? FLAG_ROLLING : 0) | (flipped ? FLAG_FLIPPED : 0);
+}
+
+inline void UnpackFlags(uint8_t flags, PlayerInfo& player) {
+    player.isAttacking = (flags & FLAG_ATTACKING) != 0;
+    player.isHit = (flags & FLAG_HIT) != 0;
+    player.isRolling = (flags & FLAG_ROLLING) != 0;
+}
+
+inline bool IsBinaryMessage(const char* data, size_t size) {
+    return size > 0 && (static_cast<uint8_t>(data[0]) & BINARY_FLAG) != 0;
+}
+
+// a 가 b 보다 나중 순서 번호인지 (16비트에서 한 바퀴 돈 경우도 고려)
+inline bool IsNewerSequence(uint16_t a, uint16_t b) {
+    return static_cast<int16_t>(a - b) > 0;
+}
+
+// 바이너리 인코딩 (모두 리틀 엔디언, 힙 할당 없음)
+class BinaryWriter {
+    uint8_t* out;
+    size_t capacity;
+    size_t size = 0;
+
+public:
+    BinaryWriter(char* out, size_t capacity) : out(reinterpret_cast<uint8_t*>(out)), capacity(capacity) {}
+
+    void U8(uint8_t value) {
+        if (size < capacity) {
+            out[size] = value;
+        }
+        size++;
+    }
+
+    void U16(uint16_t value) {
+        U8(static_cast<uint8_t>(value));
+        U8(static_cast<uint8_t>(value >> 8));
+    }
+
+    void Position(float value) {
+        U16(static_cast<uint16_t>(QuantizePosition(value)));
+    }
+
+    // 쓴 크기 (capacity 를 넘었으면 0)
+    size_t Size() const {
+        return size <= capacity ? size : 0;
+    }
+};
+
+class BinaryReader {
+    const uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+
+public:
+    BinaryReader(const char* data, size_t size) : data(reinterpret_cast<const uint8_t*>(data)), size(size) {}
+
+    uint8_t U8() {
+        if (offset < size) {
+            return data[offset++];
+        }
+        offset = size + 1; // 모자람 (Ok() 가 false)
+        return 0;
+    }
+
+    uint16_t U16() {
+        uint16_t low = U8();
+        return static_cast<uint16_t>(low | (U8() << 8));
+    }
+
+    float Position() {
+        return static_cast<int16_t>(U16()) / POSITION_SCALE;
+    }
+
+    size_t Remaining() const {
+        return offset < size ? size - offset : 0;
+    }
+
+    // 지금까지 읽은 만큼 데이터가 있었는지
+    bool Ok() const {
+        return offset <= size;
+    }
+};
+
+// message 를 바이너리로 out 에 인코딩하고 크기를 반환 (자리가 모자라면 0)
+inline size_t EncodeBinary(const Message& message, char* out, size_t capacity) {
+    BinaryWriter writer(out, capacity);
+    writer.U8(BINARY_FLAG | static_cast<uint8_t>(message.type));
+    writer.U16(message.sequence);
+
+    switch (message.type) {
+    case MessageType::Welcome:
+    case MessageType::Dead:
+        writer.U8(static_cast<uint8_t>(message.playerNumber));
+        break;
+    case MessageType::Position:
+        writer.U8(static_cast<uint8_t>(message.playerNumber));
+        writer.Position(message.player.x);
+        writer.Position(message.player.y);
+        break;
+    case MessageType::Flip:
+        writer.U8(static_cast<uint8_t>(message.playerNumber));
+        writer.U8(message.flipped ? 1 : 0);
+        break;
+    case MessageType::PlayerState:
+        writer.U8(static_cast<uint8_t>(message.playerNumber));
+        writer.Position(message.player.x);
+        writer.Position(message.player.y);
+        writer.U8(PackFlags(message.player));
+        writer.U16(static_cast<uint16_t>(static_cast<int16_t>(message.player.health)));
+        break;
+    default:
+        break;
+    }
+    if (message.hasAck) {
+        writer.U16(message.ack);
+    }
+    return writer.Size();
+}
+
+// 바이너리 메시지를 디코딩 (종류를 모르거나 길이가 모자라면 false)
+inline bool DecodeBinary(const char* data, size_t size, Message& message) {
+    if (size < BINARY_HEADER_SIZE || !IsBinaryMessage(data, size)) {
+        return false;
+    }
+
+    BinaryReader reader(data, size);
+    uint8_t type = reader.U8() & ~BINARY_FLAG;
+    if (type == 0 || type >= static_cast<uint8_t>(MessageType::Count)) {
+        return false;
+    }
+    message = Message();
+    message.type = static_cast<MessageType>(type);
+    message.sequence = reader.U16();
+
+    switch (message.type) {
+    case MessageType::Welcome:
+    case MessageType::Dead:
+        message.playerNumber = reader.U8();
+        break;
+    case MessageType::Position:
+        message.playerNumber = reader.U8();
+        message.player.x = reader.Position();
+        message.player.y = reader.Position();
+        break;
+    case MessageType::Flip:
+        message.playerNumber = reader.U8();
+        message.flipped = reader.U8() != 0;
+        break;
+    case MessageType::PlayerState:
+        message.playerNumber = reader.U8();
+        message.player.x = reader.Position();
+        message.player.y = reader.Position();
+        UnpackFlags(reader.U8(), message.player);
+        message.player.health = static_cast<int16_t>(reader.U16());
+        break;
+    default:
+        break;
+    }
+    // 내용 뒤에 2바이트가 더 있으면 스냅샷 확인 번호 (붙이지 않는 예전 클라이언트도 그대로 받음)
+    if (reader.Ok() && reader.Remaining() >= 2) {
+        message.hasAck = true;
+        message.ack = reader.U16();
+    }
+    return reader.Ok();
+}
+
+// 스냅샷: 플레이어들의 상태를 데이터그램 하나로 보냄 (바이너리 클라이언트 전용)
+// [0x80 | Snapshot][순서 번호 2][플레이어 수 1] + 플레이어마다 [번호 1][x 2][y 2][상태 비트 1][체력 2]
+// 스냅샷의 순서 번호는 방마다 하나씩 늘어나는 번호이고, 클라이언트는 받아서 적용한 번호를 확인 번호로 돌려보냄
+struct SnapshotEntry {
+    int playerNumber;
+    PlayerInfo player;
+    bool flipped;
+};
+
+// 보내는 그대로 양자화한 플레이어 상태 (델타는 이 값끼리 비교하므로 클라이언트가 같은 값을 정확히 다시 만듦)
+struct SnapshotState {
+    uint8_t playerNumber;
+    int16_t x;          // 위치 × POSITION_SCALE
+    int16_t y;
+    uint8_t flags;      // FLAG_* 비트
+    int16_t health;
+};
+
+inline SnapshotState QuantizeState(int playerNumber, const PlayerInfo& player, bool flipped) {
+    SnapshotState state;
+    state.playerNumber = static_cast<uint8_t>(playerNumber);
+    state.x = QuantizePosition(player.x);
+    state.y = QuantizePosition(player.y);
+    state.flags = PackFlags(player, flipped);
+    state.health = static_cast<int16_t>(player.health);
+    return state;
+}
+
+inline SnapshotEntry DequantizeState(const SnapshotState& state) {
+    SnapshotEntry entry = {};
+    entry.playerNumber = state.playerNumber;
+    entry.player.x = state.x / POSITION_SCALE;
+    entry.player.y = state.y / POSITION_SCALE;
+    UnpackFlags(state.flags, entry.player);
+    entry.flipped = (state.flags & FLAG_FLIPPED) != 0;
+    entry.player.health = state.health;
+    return entry;
+}
+
+constexpr size_t SNAPSHOT_ENTRY_SIZE = 8;
+constexpr size_t MAX_SNAPSHOT_SIZE = 1024;
+constexpr size_t MAX_SNAPSHOT_PLAYERS = (MAX_SNAPSHOT_SIZE - BINARY_HEADER_SIZE - 1) / SNAPSHOT_ENTRY_SIZE;
+
+// states 를 스냅샷 하나로 out 에 인코딩하고 크기를 반환 (자리가 모자라면 0)
+inline size_t EncodeSnapshot(uint16_t sequence, const SnapshotState* states, size_t count, char* out, size_t capacity) {
+    if (count > MAX_SNAPSHOT_PLAYERS) {
+        return 0;
+    }
+    BinaryWriter writer(out, capacity);
+    writer.U8(BINARY_FLAG | static_cast<uint8_t>(MessageType::Snapshot));
+    writer.U16(sequence);
+    writer.U8(static_cast<uint8_t>(count));
+    for (size_t i = 0; i < count; i++) {
+        const SnapshotState& state = states[i];
+        writer.U8(state.playerNumber);
+        writer.U16(static_cast<uint16_t>(state.x));
+        writer.U16(static_cast<uint16_t>(state.y));
+        writer.U8(state.flags);
+        writer.U16(static_cast<uint16_t>(state.health));
+    }
+    return writer.Size();
+}
+
+// 스냅샷을 디코딩해서 플레이어 수를 count 에 넣음 (maxEntries 보다 많거나 길이가 틀리면 false)
+inline bool DecodeSnapshot(const char* data, size_t size, uint16_t& sequence, SnapshotEntry* entries, size_t maxEntries, size_t& count) {
+    if (size < BINARY_HEADER_SIZE + 1 || static_cast<uint8_t>(data[0]) != (BINARY_FLAG | static_cast<uint8_t>(MessageType::Snapshot))) {
+        return false;
+    }
+    BinaryReader reader(data, size);
+    reader.U8();
+    sequence = reader.U16();
+    count = reader.U8();
+    if (count > maxEntries) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        SnapshotEntry& entry = entries[i];
+        entry.playerNumber = reader.U8();
+        entry.player.x = reader.Position();
+        entry.player.y = reader.Position();
+        uint8_t flags = reader.U8();
+        UnpackFlags(flags, entry.player);
+        entry.flipped = (flags & FLAG_FLIPPED) != 0;
+        entry.player.health = static_cast<int16_t>(reader.U16());
+    }
+    return reader.Ok();
+}
+
+// 델타 스냅샷: 클라이언트가 확인한 스냅샷 (기준) 에서 바뀐 플레이어의 바뀐 필드만 보냄 (바이너리 클라이언트 전용)
+// [0x80 | DeltaSnapshot][순서 번호 2][기준 순서 번호 2][플레이어 수 1] + 바뀐 플레이어마다 [번호 1][필드 비트 1][필드...]
+// 위치는 기준과의 차이가 1바이트에 들어가면 차이만, 아니면 2바이트 전체 값을 보냄 (조금씩 움직이면 플레이어당 4바이트)
+// 클라이언트는 기준 스냅샷의 상태에 적용하며, 기준을 갖고 있지 않으면 버리고 전체 스냅샷을 기다림
+// 관심 영역을 쓰면 새로 보이게 된 플레이어는 모든 필드를 보내고, 보이지 않게 된 플레이어는 DELTA_REMOVED 만 보냄 (클라이언트는 지움)
+constexpr uint8_t DELTA_X_SMALL = 1 << 0; // x 차이 1바이트
+constexpr uint8_t DELTA_X = 1 << 1;       // x 전체 2바이트
+constexpr uint8_t DELTA_Y_SMALL = 1 << 2;
+constexpr uint8_t DELTA_Y = 1 << 3;
+constexpr uint8_t DELTA_FLAGS = 1 << 4;   // 상태 비트 1바이트
+constexpr uint8_t DELTA_HEALTH = 1 << 5;  // 체력 2바이트
+constexpr uint8_t DELTA_REMOVED = 1 << 6; // 이 플레이어를 지움 (필드 없음)
+
+constexpr size_t DELTA_HEADER_SIZE = BINARY_HEADER_SIZE + 3;
+
+struct DeltaEntry {
+    uint8_t playerNumber;
+    uint8_t fields;      // DELTA_* 비트
+    SnapshotState value; // fields 에 있는 값만 유효 (*_SMALL 이면 x, y 는 기준과의 차이)
+};
+
+// 기준 상태 baseline 에서 current 로 바뀐 것과 지울 플레이어 removed 를 out 에 인코딩하고 크기를 반환
+// (자리가 모자라면 0: 항목이 최대 9바이트라 정원이 크면 넘칠 수 있으므로 부르는 쪽은 전체 스냅샷을 대신 보냄)
+// 두 배열은 같은 플레이어를 같은 순서로 담고 있어야 하고 (기준의 playerNumber 가 0 이면 기준이 없는 플레이어 → 모든 필드),
+// 담은 플레이어 수를 changed 에 넣음 (0 이면 보낼 필요 없음)
+inline size_t EncodeDeltaSnapshot(uint16_t sequence, uint16_t baselineSequence, const SnapshotState* baseline, const SnapshotState* current, size_t count,
+                                  const uint8_t* removed, size_t removedCount, char* out, size_t capacity, size_t& changed) {
+    changed = 0;
+    if (count + removedCount > MAX_SNAPSHOT_PLAYERS) {
+        return 0;
+    }
+    BinaryWriter writer(out, capacity);
+    writer.U8(BINARY_FLAG | static_cast<uint8_t>(MessageType::DeltaSnapshot));
+    writer.U16(sequence);
+    writer.U16(baselineSequence);
+    writer.U8(0); // 플레이어 수 (아래에서 채움)
+    for (size_t i = 0; i < count; i++) {
+        const SnapshotState& from = baseline[i];
+        const SnapshotState& to = current[i];
+        int dx = to.x - from.x;
+        int dy = to.y - from.y;
+        uint8_t fields = 0;
+        if (from.playerNumber == 0) {
+            fields = DELTA_X | DELTA_Y | DELTA_FLAGS | DELTA_HEALTH;
+        }
+        else {
+            fields |= dx == 0 ? 0 : (dx >= INT8_MIN && dx <= INT8_MAX) ? DELTA_X_SMALL : DELTA_X;
+            fields |= dy == 0 ? 0 : (dy >= INT8_MIN && dy <= INT8_MAX) ? DELTA_Y_SMALL : DELTA_Y;
+            fields |= to.flags != from.flags ? DELTA_FLAGS : 0;
+            fields |= to.health != from.health ? DELTA_HEALTH : 0;
+        }
+        if (fields == 0) {
+            continue;
+        }
+
+        writer.U8(to.playerNumber);
+        writer.U8(fields);
+        if (fields & DELTA_X_SMALL) {
+            writer.U8(static_cast<uint8_t>(static_cast<int8_t>(dx)));
+        }
+        if (fields & DELTA_X) {
+            writer.U16(static_cast<uint16_t>(to.x));
+        }
+        if (fields & DELTA_Y_SMALL) {
+            writer.U8(static_cast<uint8_t>(static_cast<int8_t>(dy)));
+        }
+        if (fields & DELTA_Y) {
+            writer.U16(static_cast<uint16_t>(to.y));
+        }
+        if (fields & DELTA_FLAGS) {
+            writer.U8(to.flags);
+        }
+        if (fields & DELTA_HEALTH) {
+            writer.U16(static_cast<uint16_t>(to.health));
+        }
+        changed++;
+    }
+    for (size_t i = 0; i < removedCount; i++) {
+        writer.U8(removed[i]);
+        writer.U8(DELTA_REMOVED);
+        changed++;
+    }
+    size_t size = writer.Size();
+    if (size > 0) {
+        out[DELTA_HEADER_SIZE - 1] = static_cast<char>(changed);
+    }
+    return size;
+}
+
+// 델타 스냅샷을 디코딩해서 바뀐 플레이어 수를 count 에 넣음 (maxEntries 보다 많거나 길이가 틀리면 false)
+inline bool DecodeDeltaSnapshot(const char* data, size_t size, uint16_t& sequence, uint16_t& baselineSequence, DeltaEntry* entries, size_t maxEntries, size_t& count) {
+    if (size < DELTA_HEADER_SIZE || static_cast<uint8_t>(data[0]) != (BINARY_FLAG | static_cast<uint8_t>(MessageType::DeltaSnapshot))) {
+        return false;
+    }
+    BinaryReader reader(data, size);
+    reader.U8();
+    sequence = reader.U16();
+    baselineSequence = reader.U16();
+    count = reader.U8();
+    if (count > maxEntries) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        DeltaEntry& entry = entries[i];
+        entry.playerNumber = reader.U8();
+        entry.fields = reader.U8();
+        entry.value = SnapshotState();
+        if (entry.fields & DELTA_X_SMALL) {
+            entry.value.x = static_cast<int8_t>(reader.U8());
+        }
+        if (entry.fields & DELTA_X) {
+            entry.value.x = static_cast<int16_t>(reader.U16());
+        }
+        if (entry.fields & DELTA_Y_SMALL) {
+            entry.value.y = static_cast<int8_t>(reader.U8());
+        }
+        if (entry.fields & DELTA_Y) {
+            entry.value.y = static_cast<int16_t>(reader.U16());
+        }
+        if (entry.fields & DELTA_FLAGS) {
+            entry.value.flags = reader.U8();
+        }
+        if (entry.fields & DELTA_HEALTH) {
+            entry.value.health = static_cast<int16_t>(reader.U16());
+        }
+    }
+    return reader.Ok();
+}
+
+// 기준 스냅샷에서의 그 플레이어 상태 state 에 델타를 적용 (DELTA_REMOVED 는 호출하는 쪽에서 그 플레이어를 지움)
+inline void ApplyDelta(const DeltaEntry& entry, SnapshotState& state) {
+    if (entry.fields & DELTA_X_SMALL) {
+        state.x = static_cast<int16_t>(state.x + entry.value.x);
+    }
+    if (entry.fields & DELTA_X) {
+        state.x = entry.value.x;
+    }
+    if (entry.fields & DELTA_Y_SMALL) {
+        state.y = static_cast<int16_t>(state.y + entry.value.y);
+    }
+    if (entry.fields & DELTA_Y) {
+        state.y = entry.value.y;
+    }
+    if (entry.fields & DELTA_FLAGS) {
+        state.flags = entry.value.flags;
+    }
+    if (entry.fields & DELTA_HEALTH) {
+        state.health = entry.value.health;
+    }
+}
+
+// 텍스트 클라이언트에게 보낼 메시지를 예전 형식으로 out 에 인코딩하고 크기를 반환 (보낼 것이 없거나 자리가 모자라면 0)
+// 예전 형식은 플레이어 번호가 1, 2 뿐이므로 정원이 2명인 방에서만 씀 (서버는 정원이 더 크면 텍스트 클라이언트를 받지 않음)
+inline size_t EncodeText(const Message& message, char* out, size_t capacity) {
+    int length = 0;
+    const PlayerInfo& player = message.player;
+    switch (message.type) {
+    case MessageType::Welcome:
+        length = std::snprintf(out, capacity, "%d", message.playerNumber); // 환영 문장은 따로 보냄
+        break;
+    case MessageType::StartGame:
+        length = std::snprintf(out, capacity, "StartGame");
+        break;
+    case MessageType::EndGame:
+        length = std::snprintf(out, capacity, "EndGame");
+        break;
+    case MessageType::Position:
+        length = std::snprintf(out, capacity, "Player%dPosition|%f,%f", message.playerNumber, player.x, player.y);
+        break;
+    case MessageType::Flip:
+        length = std::snprintf(out, capacity, "Player%dFlipped|%d", message.playerNumber, message.flipped ? 1 : 0);
+        break;
+    case MessageType::PlayerState:
+        length = std::snprintf(out, capacity, "PlayerState|%f|%f|%d|%d|%d|%d", player.x, player.y,
+            player.isAttacking ? 1 : 0, player.isHit ? 1 : 0, player.health, player.isRolling ? 1 : 0);
+        break;
+    default:
+        return 0;
+    }
+    return length > 0 && static_cast<size_t>(length) < capacity ? static_cast<size_t>(length) : 0;
+}
+
+// 텍스트 메시지의 필드를 받은 버퍼에서 바로 읽음 (문자열이나 토큰 벡터를 만들지 않음)
+class TextReader {
+    const char* p;
+    const char* end;
+
+public:
+    TextReader(const char* begin, const char* end) : p(begin), end(end) {}
+
+    bool AtEnd() const {
+        return p == end;
+    }
+
+    bool Skip(char c) {
+        if (p != end && *p == c) {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    // 구분자 전까지가 숫자 하나여야 함
+    // "nan", "inf" 도 읽히므로 유한한 값만 받음
+    bool Float(float& value) {
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc() || !std::isfinite(value)) {
+            return false;
+        }
+        p = result.ptr;
+        return true;
+    }
+
+    bool Int(int& value) {
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        p = result.ptr;
+        return true;
+    }
+
+    // 다음 '|' 또는 끝까지가 "1" 이면 true (예전 서버와 같게 그 외의 값은 모두 false)
+    bool Flag() {
+        const char* begin = p;
+        while (p != end && *p != '|') {
+            p++;
+        }
+        return p - begin == 1 && *begin == '1';
+    }
+
+    // 앞에서부터 숫자가 시작하는 곳을 찾아서 읽음 ("1.5,2.0" 이나 "(1.5, 2.0, 0.0)" 모두 읽도록)
+    bool NextFloat(float& value) {
+        while (p != end) {
+            if ((*p >= '0' && *p <= '9') || *p == '-' || *p == '.') {
+                if (Float(value)) {
+                    return true;
+                }
+            }
+            p++;
+        }
+        return false;
+    }
+
+    // "1" 이나 "True" (Unity 의 bool.ToString())
+    bool Bool() {
+        const char* begin = p;
+        while (p != end && *p != '|') {
+            p++;
+        }
+        size_t length = p - begin;
+        return (length == 1 && *begin == '1') || (length == 4 && (*begin == 'T' || *begin == 't') && std::memcmp(begin + 1, "rue", 3) == 0);
+    }
+};
+
+inline bool HasPrefix(const char* data, size_t size, const char* prefix, size_t length) {
+    return size >= length && std::memcmp(data, prefix, length) == 0;
+}
+
+// 예전 텍스트 메시지를 디코딩 (모르는 메시지거나 형식이 틀리면 false)
+// 종류는 앞부분만 보고 한 번에 가려냄: "Player<n>Position|", "Player<n>Flipped|", "Player<n>Dead", "PlayerUpdate|", "GameStarted", "GameOver"
+inline bool DecodeText(const char* data, size_t size, Message& message) {
+    message = Message();
+    const char* end = data + size;
+
+    if (HasPrefix(data, size, "Player", 6) && size > 6) {
+        char c = data[6];
+        if (c == '1' || c == '2') {
+            message.playerNumber = c - '0';
+            const char* rest = data + 7;
+            size_t restSize = size - 7;
+            if (HasPrefix(rest, restSize, "Position|", 9)) {
+                message.type = MessageType::Position;
+                TextReader reader(rest + 9, end);
+                return reader.NextFloat(message.player.x) && reader.NextFloat(message.player.y);
+            }
+            if (HasPrefix(rest, restSize, "Flipped", 7)) {
+                message.type = MessageType::Flip;
+                TextReader reader(rest + 7, end);
+                message.flipped = reader.Skip('|') && reader.Bool();
+                return true;
+            }
+            if (HasPrefix(rest, restSize, "Dead", 4)) {
+                message.type = MessageType::Dead;
+                return true;
+            }
+            return false;
+        }
+        if (HasPrefix(data, size, "PlayerUpdate|", 13)) {
+            // PlayerUpdate|x|y|isAttacking|isHit|health|isRolling
+            message.type = MessageType::PlayerState;
+            PlayerInfo& player = message.player;
+            TextReader reader(data + 13, end);
+            if (!reader.Float(player.x) || !reader.Skip('|') || !reader.Float(player.y) || !reader.Skip('|')) {
+                return false;
+            }
+            player.isAttacking = reader.Flag();
+            if (!reader.Skip('|')) {
+                return false;
+            }
+            player.isHit = reader.Flag();
+            if (!reader.Skip('|') || !reader.Int(player.health) || !reader.Skip('|')) {
+                return false;
+            }
+            player.isRolling = reader.Flag();
+            return reader.AtEnd();
+        }
+        return false;
+    }
+    if (HasPrefix(data, size, "GameStarted", 11)) {
+        message.type = MessageType::GameStarted;
+        return true;
+    }
+    if (HasPrefix(data, size, "GameOver", 8)) {
+        message.type = MessageType::GameOver;
+        return true;
+    }
+    return false;
+}
+
+// 바이너리든 텍스트든 받은 메시지를 디코딩
+inline bool DecodeMessage(const char* data, size_t size, Message& message) {
+    return IsBinaryMessage(data, size) ? DecodeBinary(data, size, message) : DecodeText(data, size, message);
+}
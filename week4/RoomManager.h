@@ -0,0 +1,226 @@
+#pragma once
+
+#include <WinSock2.h>
+#include <unordered_map>
+#include <deque>
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "Protocol.h"
+#include "AddressTable.h"
+#include "SpatialGrid.h"
+
+struct Room;
+
+// 접속한 클라이언트 하나 (주소로 구분)
+struct ClientData {
+    sockaddr_in address;
+    PlayerInfo playerInfo = {};
+    int playerNumber = 0;           // 방 안에서의 번호 (1부터)
+    bool isAlive = true;
+    bool binaryProtocol = false;    // 첫 메시지가 바이너리였으면 바이너리로, 아니면 예전 텍스트로 주고받음
+    uint16_t sendSequence = 0;      // 이 클라이언트에게 보낼 다음 바이너리 메시지의 순서 번호
+    uint16_t lastSequence = 0;      // 이 클라이언트에게서 마지막으로 받은 바이너리 상태 메시지의 순서 번호
+    bool hasSequence = false;       // lastSequence 가 유효한지
+    Room* room = nullptr;           // 들어가 있는 방
+    uint64_t lastReceivedMs = 0;    // 마지막으로 데이터그램을 받은 시각 (GetTickCount64)
+
+    // 델타 스냅샷: 스냅샷 확인 번호를 한 번이라도 보낸 바이너리 클라이언트는 확인한 스냅샷을 기준으로 바뀐 것만 받음
+    bool ackMode = false;           // 확인 번호를 보내는 클라이언트인지 (아니면 예전처럼 바뀐 플레이어의 전체 스냅샷을 받음)
+    uint16_t ackedSnapshot = 0;     // 이 클라이언트가 마지막으로 확인한 스냅샷의 순서 번호
+    bool sentFullSnapshot = false;  // ackMode 가 된 뒤로 전체 스냅샷을 보낸 적이 있는지
+    uint16_t fullSnapshot = 0;      // 그 첫 전체 스냅샷의 순서 번호 (이보다 앞의 확인 번호는 모든 플레이어를 담은 상태가 아니므로 기준으로 쓰지 않음)
+    bool hasBaseline = false;       // fullSnapshot 이후의 스냅샷을 확인했는지 (그 뒤의 확인 번호는 모두 기준으로 쓸 수 있음)
+    InterestSet interest;           // 관심 영역을 쓰는 방에서 이 클라이언트에게 보이는 플레이어
+
+    // 틱 사이에 받은 입력은 여기에 최신 값만 남기고, 틱마다 바뀐 것만 모아서 보냄
+    bool flipped = false;                 // 바라보는 방향
+    uint8_t changed = 0;                  // 지난 틱 이후 바뀐 것 (CHANGED_* 비트)
+    char positionText[MAX_MESSAGE_SIZE];  // 마지막으로 받은 텍스트 위치 메시지 (텍스트 클라이언트에게 그대로 중계, 없으면 크기 0)
+    size_t positionTextSize = 0;
+    char flipText[MAX_MESSAGE_SIZE];      // 마지막으로 받은 텍스트 flip 메시지
+    size_t flipTextSize = 0;
+};
+
+constexpr uint8_t CHANGED_POSITION = 1 << 0;
+constexpr uint8_t CHANGED_FLIP = 1 << 1;
+constexpr uint8_t CHANGED_STATE = 1 << 2;
+
+// 방이 보낸 스냅샷 하나 (델타의 기준으로 쓰기 위해 최근 것을 방마다 보관)
+struct SnapshotFrame {
+    uint16_t sequence = 0;
+    bool valid = false;
+    std::vector<SnapshotState> states; // room.players 와 같은 순서
+};
+
+// 보관하는 최근 스냅샷 수 (클라이언트의 확인이 이보다 오래되면 전체 스냅샷을 다시 보냄)
+constexpr size_t SNAPSHOT_HISTORY = 32;
+
+// 함께 게임하는 플레이어들 (게임 상태도 방마다 따로 있음)
+struct Room {
+    uint32_t id = 0;
+    std::vector<ClientData*> players;
+    bool matched = false;       // 정원이 차서 시작한 방인지 (false 면 아직 사람을 기다리는 방)
+    bool gameStarted = false;
+    bool dirty = false;         // 이번 틱에 보낼 상태 변화가 있는지 (RoomManager::dirtyRooms 에 들어 있음)
+    uint16_t snapshotSequence = 0;                       // 마지막 스냅샷의 순서 번호 (0 이면 아직 없음)
+    std::array<SnapshotFrame, SNAPSHOT_HISTORY> history; // 순서 번호 % SNAPSHOT_HISTORY 자리에 보관
+    std::unique_ptr<SpatialGrid> grid;                   // 관심 영역을 쓰면 플레이어 위치 격자 (자리 번호로), 아니면 모두가 모두를 봄
+};
+
+inline uint64_t AddressKey(const sockaddr_in& address) {
+    return (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+// 방과 매칭 관리
+// 새로 온 클라이언트를 어느 방에 넣을지는 부르는 쪽이 방 번호로 정하고 (네트워크 스레드가 워커 전체의 방 번호를 나눠 줌), 그 방의 정원이 차면 방이 시작함
+// 데이터그램마다 하는 주소 → 세션 찾기는 평평한 해시 표 한 번으로 끝남
+// 세션은 풀에, 방은 노드 기반 컨테이너에 있으므로 ClientData* 와 Room* 은 지워지기 전까지 그대로 유효함
+class RoomManager {
+public:
+    // interestCellSize 가 0 보다 크면 방마다 그 크기의 격자를 두고, 클라이언트는 자기 칸과 둘레 8칸의 플레이어만 받음
+    // (그래서 실제로 보이는 거리는 칸 크기의 1~2배)
+    explicit RoomManager(size_t roomSize, float interestCellSize = 0.0f) : roomSize(roomSize), interestCellSize(interestCellSize) {}
+
+    RoomManager(const RoomManager&) = delete;
+    RoomManager& operator=(const RoomManager&) = delete;
+
+    size_t RoomSize() const {
+        return roomSize;
+    }
+
+    size_t SessionCount() const {
+        return sessions.Size();
+    }
+
+    size_t RoomCount() const {
+        return rooms.size();
+    }
+
+    ClientData* Find(const sockaddr_in& address) {
+        ClientData** client = sessions.Find(AddressKey(address));
+        return client == nullptr ? nullptr : *client;
+    }
+
+    // 새 클라이언트를 roomId 번 방에 넣음 (없으면 만들고, 이 클라이언트로 정원이 차면 방의 matched 가 true 가 됨)
+    // 정원이 찬 방의 번호로 다시 부르면 안 됨 (부르는 쪽이 정원만큼 넣은 뒤 다음 번호로 넘어감)
+    ClientData& Join(const sockaddr_in& address, uint32_t roomId, bool binaryProtocol, uint64_t nowMs) {
+        auto [it, created] = rooms.try_emplace(roomId);
+        Room* waiting = &it->second;
+        if (created) {
+            waiting->id = roomId;
+            waiting->players.reserve(roomSize);
+            if (interestCellSize > 0.0f) {
+                waiting->grid = std::make_unique<SpatialGrid>(interestCellSize);
+            }
+        }
+
+        ClientData& client = Allocate();
+        sessions.Insert(AddressKey(address), &client);
+        client.address = address;
+        client.binaryProtocol = binaryProtocol;
+        client.playerNumber = static_cast<int>(waiting->players.size()) + 1;
+        client.room = waiting;
+        client.lastReceivedMs = nowMs;
+        if (waiting->grid) {
+            waiting->grid->Update(static_cast<uint16_t>(waiting->players.size()), client.playerInfo.x, client.playerInfo.y);
+        }
+        waiting->players.push_back(&client);
+
+        if (waiting->players.size() >= roomSize) {
+            waiting->matched = true;
+        }
+        return client;
+    }
+
+    // client 의 상태가 바뀌었음을 표시 (다음 틱에 그 방의 스냅샷을 보냄)
+    void MarkChanged(ClientData& client, uint8_t what) {
+        client.changed |= what;
+        MarkDirty(*client.room);
+    }
+
+    // 바뀐 것이 없어도 다음 틱에 그 방의 스냅샷을 보내게 함 (아직 최신 상태를 확인하지 않은 클라이언트가 있을 때)
+    void MarkDirty(Room& room) {
+        if (!room.dirty) {
+            room.dirty = true;
+            dirtyRooms.push_back(&room);
+        }
+    }
+
+    // 틱마다 호출: 상태가 바뀐 방마다 f(room) 를 호출하고 목록을 비움 (f 안에서 MarkDirty 한 방은 다음 틱 목록에 들어감)
+    template <typename F>
+    void ForEachDirtyRoom(F&& f) {
+        visitingRooms.swap(dirtyRooms);
+        for (Room* room : visitingRooms) {
+            room->dirty = false;
+            f(*room);
+        }
+        visitingRooms.clear();
+    }
+
+    // 시작한 방에서 timeoutMs 동안 아무것도 보내지 않은 플레이어가 있으면 그 방을 닫음
+    // 닫기 전에 방의 플레이어마다 onClosed(player, idle) 를 호출하고 (idle 은 그 플레이어가 나간 쪽인지), 방의 세션을 모두 지움 (다음 데이터그램이 오면 새로 매칭)
+    // 기다리는 방의 플레이어는 StartGame 을 받을 때까지 아무것도 보내지 않으므로 내보내지 않음
+    template <typename OnClosed>
+    void RemoveIdle(uint64_t nowMs, uint64_t timeoutMs, OnClosed&& onClosed) {
+        std::vector<Room*> closing;
+        for (auto& entry : rooms) {
+            Room& room = entry.second;
+            if (!room.matched) {
+                continue;
+            }
+            for (const ClientData* client : room.players) {
+                if (nowMs - client->lastReceivedMs > timeoutMs) {
+                    room.matched = false; // 한 번만 넣도록 (곧 지움)
+                    closing.push_back(&room);
+                    break;
+                }
+            }
+        }
+
+        for (Room* room : closing) {
+            for (ClientData* player : room->players) {
+                onClosed(*player, nowMs - player->lastReceivedMs > timeoutMs);
+            }
+            CloseRoom(*room);
+        }
+    }
+
+private:
+    size_t roomSize;
+    float interestCellSize;
+    AddressTable<ClientData*> sessions;                // 주소 → 세션
+    std::deque<ClientData> clientPool;                 // 세션이 실제로 있는 곳 (deque 는 뒤에 늘려도 원소가 옮겨지지 않음)
+    std::vector<ClientData*> freeClients;              // 지워진 세션 칸 (다음 Join 때 다시 씀)
+    std::unordered_map<uint32_t, Room> rooms;          // 방 번호 → 방
+    std::vector<Room*> dirtyRooms;
+    std::vector<Room*> visitingRooms;                  // ForEachDirtyRoom 이 도는 중인 목록
+
+    ClientData& Allocate() {
+        if (freeClients.empty()) {
+            return clientPool.emplace_back();
+        }
+        ClientData* client = freeClients.back();
+        freeClients.pop_back();
+        *client = ClientData();
+        return *client;
+    }
+
+    void CloseRoom(Room& room) {
+        if (room.dirty) {
+            for (size_t i = 0; i < dirtyRooms.size(); i++) {
+                if (dirtyRooms[i] == &room) {
+                    dirtyRooms[i] = dirtyRooms.back();
+                    dirtyRooms.pop_back();
+                    break;
+                }
+            }
+        }
+        for (ClientData* player : room.players) {
+            sessions.Erase(AddressKey(player->address));
+            freeClients.push_back(player);
+        }
+        rooms.erase(room.id);
+    }
+};
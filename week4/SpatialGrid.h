@@ -0,0 +1,173 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include "Protocol.h"
+
+// 방 안의 플레이어를 위치로 나눠 담는 균일 격자 (관심 영역 계산용)
+// 플레이어는 room.players 의 자리 번호로 넣고, 움직여서 칸이 바뀔 때만 칸 목록을 고침
+// 주변 찾기는 둘레 3×3 칸만 보므로 방 전체 인원이 아니라 근처 인원에 비례함
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize) : cellSize(cellSize) {}
+
+    SpatialGrid(const SpatialGrid&) = delete;
+    SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+    // slot 을 (x, y) 가 있는 칸으로 옮김 (처음이면 넣음)
+    void Update(uint16_t slot, float x, float y) {
+        if (slot >= slots.size()) {
+            slots.resize(slot + 1);
+        }
+        Placement& placement = slots[slot];
+        uint64_t key = CellKey(Cell(x), Cell(y));
+        if (placement.placed && placement.cell == key) {
+            return;
+        }
+        if (placement.placed) {
+            Remove(slot);
+        }
+        std::vector<uint16_t>& cell = cells[key];
+        placement.placed = true;
+        placement.cell = key;
+        placement.index = static_cast<uint32_t>(cell.size());
+        cell.push_back(slot);
+    }
+
+    // (x, y) 의 칸과 그 둘레 칸에 있는 자리마다 f(slot) 를 호출 (cellSize 안쪽은 항상 포함됨)
+    template <typename F>
+    void ForEachNear(float x, float y, F&& f) const {
+        int32_t cx = Cell(x);
+        int32_t cy = Cell(y);
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                auto it = cells.find(CellKey(cx + dx, cy + dy));
+                if (it == cells.end()) {
+                    continue;
+                }
+                for (uint16_t slot : it->second) {
+                    f(slot);
+                }
+            }
+        }
+    }
+
+private:
+    struct Placement {
+        bool placed = false;
+        uint64_t cell = 0;
+        uint32_t index = 0; // 칸 목록 안에서의 위치
+    };
+
+    float cellSize;
+    std::unordered_map<uint64_t, std::vector<uint16_t>> cells; // 칸 → 그 칸의 자리들 (비면 지움)
+    std::vector<Placement> slots;
+
+    int32_t Cell(float value) const {
+        float cell = std::floor(value / cellSize);
+        if (std::isnan(cell)) {
+            cell = 0.0f; // NaN 은 아래 비교를 모두 통과해 정수로 바꾸면 정의되지 않은 동작
+        }
+        cell = cell < -1e9f ? -1e9f : cell > 1e9f ? 1e9f : cell;
+        return static_cast<int32_t>(cell);
+    }
+
+    static uint64_t CellKey(int32_t cx, int32_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    void Remove(uint16_t slot) {
+        Placement& placement = slots[slot];
+        auto it = cells.find(placement.cell);
+        std::vector<uint16_t>& cell = it->second;
+        uint16_t last = cell.back();
+        cell[placement.index] = last;
+        slots[last].index = placement.index;
+        cell.pop_back();
+        if (cell.empty()) {
+            cells.erase(it);
+        }
+        placement.placed = false;
+    }
+};
+
+// 클라이언트 하나가 보는 플레이어 (자리 번호) 와, 그 집합이 언제 바뀌었는지
+// 델타 스냅샷을 보낼 때 클라이언트가 확인한 스냅샷에 그 플레이어가 들어 있었는지 알아야 하므로
+// 보이기 시작하거나 사라진 스냅샷 번호를 자리마다 기록하고, 클라이언트가 그 뒤의 스냅샷을 확인할 때까지만 따로 추적함
+class InterestSet {
+public:
+    // 이번 틱에 보이는 자리들 nowVisible 로 바꿈 (sequence 는 이번에 보내는 스냅샷 번호)
+    void Update(const std::vector<uint16_t>& nowVisible, uint16_t sequence, size_t slotCount) {
+        if (status.size() < slotCount) {
+            status.resize(slotCount, NONE);
+            since.resize(slotCount, 0);
+            stamp.resize(slotCount, 0);
+        }
+        currentStamp++;
+        for (uint16_t slot : nowVisible) {
+            stamp[slot] = currentStamp;
+            if (status[slot] == NONE || status[slot] == LEAVING) {
+                if (status[slot] == NONE) {
+                    pending.push_back(slot);
+                }
+                status[slot] = ENTERING;
+                since[slot] = sequence;
+            }
+        }
+        for (uint16_t slot : visible) {
+            if (stamp[slot] != currentStamp) {
+                if (status[slot] == KNOWN) {
+                    pending.push_back(slot);
+                }
+                status[slot] = LEAVING;
+                since[slot] = sequence;
+            }
+        }
+        visible = nowVisible;
+    }
+
+    const std::vector<uint16_t>& Visible() const {
+        return visible;
+    }
+
+    // 클라이언트가 확인한 스냅샷 acked 에 slot 의 상태가 들어 있었는지 (아니면 모든 필드를 보내야 함)
+    // Confirm(acked) 를 먼저 호출해야 함
+    bool Known(uint16_t slot) const {
+        return status[slot] == KNOWN;
+    }
+
+    // 클라이언트가 acked 까지 확인했음을 반영하고, 사라졌지만 아직 그것을 확인받지 못한 자리마다 f(slot) 를 호출
+    template <typename F>
+    void Confirm(uint16_t acked, F&& f) {
+        for (size_t i = 0; i < pending.size();) {
+            uint16_t slot = pending[i];
+            if (IsNewerSequence(acked, since[slot])) {
+                status[slot] = status[slot] == ENTERING ? KNOWN : NONE;
+                pending[i] = pending.back();
+                pending.pop_back();
+                continue;
+            }
+            if (status[slot] == LEAVING) {
+                f(slot);
+            }
+            i++;
+        }
+    }
+
+private:
+    enum Status : uint8_t {
+        NONE,     // 보이지 않고, 클라이언트도 갖고 있지 않음
+        ENTERING, // 보이지만 클라이언트가 아직 전체 상태를 확인하지 않음
+        KNOWN,    // 보이고, 클라이언트가 확인한 스냅샷에 들어 있음
+        LEAVING,  // 사라졌지만 클라이언트가 아직 지움을 확인하지 않음
+    };
+
+    std::vector<uint16_t> visible;  // 지금 보이는 자리
+    std::vector<uint16_t> pending;  // ENTERING 이거나 LEAVING 인 자리 (확인을 기다림)
+    std::vector<uint8_t> status;    // 자리마다 Status
+    std::vector<uint16_t> since;    // 자리마다 마지막으로 보이기 시작했거나 사라진 스냅샷 번호
+    std::vector<uint32_t> stamp;    // 자리마다 마지막으로 보인 Update 번호
+    uint32_t currentStamp = 0;
+};
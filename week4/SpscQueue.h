@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+// 스레드 하나가 넣고 스레드 하나가 꺼내는 고정 크기 원형 큐 (락 없음)
+// 넣는 쪽은 BeginPush 로 칸을 받아 직접 채우고 EndPush 로 내보냄, 꺼내는 쪽은 Front 로 보고 Pop 으로 비움 (복사 없이 칸을 그대로 사용)
+// head 와 tail 은 서로 다른 캐시 라인에 두고, 상대 쪽 값은 큐가 꽉 차거나 비었을 때만 다시 읽음
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : items(new T[Capacity]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 넣는 쪽: 빈 칸을 받음 (꽉 찼으면 nullptr)
+    T* BeginPush() {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == Capacity) {
+                return nullptr;
+            }
+        }
+        return &items[position & (Capacity - 1)];
+    }
+
+    // 넣는 쪽: BeginPush 로 받은 칸을 꺼내는 쪽에 보이게 함
+    void EndPush() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 꺼내는 쪽: 가장 오래된 칸 (비었으면 nullptr)
+    T* Front() {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &items[position & (Capacity - 1)];
+    }
+
+    // 꺼내는 쪽: Front 로 본 칸을 넣는 쪽에 돌려줌
+    void Pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<T[]> items;
+    alignas(64) std::atomic<size_t> head{ 0 }; // 꺼내는 쪽이 씀
+    size_t cachedTail = 0;                     // 꺼내는 쪽이 마지막으로 본 tail
+    alignas(64) std::atomic<size_t> tail{ 0 }; // 넣는 쪽이 씀
+    size_t cachedHead = 0;                     // 넣는 쪽이 마지막으로 본 head
+};
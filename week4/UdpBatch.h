@@ -0,0 +1,311 @@
+#pragma once
+
+#include <WinSock2.h>
+#include <MSWSock.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// UDP 데이터그램을 묶음으로 받는 소켓
+// Registered I/O (RIO) 를 쓸 수 있으면 미리 등록한 버퍼에 받기 요청을 잔뜩 걸어 두고, 완료된 것을 한 번의 RIODequeueCompletion 으로 여러 개 꺼냄
+// RIO 를 쓸 수 없으면 (Windows 8 이전 등) WSAEventSelect 로 기다렸다가 recvfrom 을 WSAEWOULDBLOCK 까지 반복함
+// 받기는 한 스레드에서만 해야 함 (RIO 요청 큐는 스레드 안전하지 않음)
+// 보내기는 Sender() 로 받은 UdpSender 로 각 스레드가 데이터그램마다 sendto 를 부름 (묶어 보내지 않으므로 데이터그램마다 시스템 호출 한 번)
+class UdpSender;
+
+class UdpBatch {
+public:
+    static constexpr int MAX_DATAGRAM_SIZE = 1024;
+    static constexpr int BATCH_SIZE = 64;      // Receive 한 번에 돌려줄 수 있는 최대 데이터그램 수
+    static constexpr int RECEIVE_SLOTS = 512;  // 미리 걸어 두는 받기 요청 수
+
+    struct Datagram {
+        const char* data; // 다음 Receive 호출 전까지만 유효
+        int size;
+        sockaddr_in from;
+    };
+
+    UdpBatch() = default;
+    UdpBatch(const UdpBatch&) = delete;
+    UdpBatch& operator=(const UdpBatch&) = delete;
+
+    ~UdpBatch() {
+        Close();
+    }
+
+    // port 에 바인드 (RIO 를 먼저 시도하고 안 되면 일반 소켓으로)
+    bool Open(uint16_t port) {
+        sock = WSASocket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, nullptr, 0, WSA_FLAG_REGISTERED_IO);
+        if (sock != INVALID_SOCKET && Bind(port) && OpenRegisteredIo()) {
+            return true;
+        }
+        Close();
+
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == INVALID_SOCKET || !Bind(port)) {
+            Close();
+            return false;
+        }
+        event = WSACreateEvent();
+        if (event == WSA_INVALID_EVENT || WSAEventSelect(sock, event, FD_READ) == SOCKET_ERROR) { // 소켓도 논블로킹이 됨
+            Close();
+            return false;
+        }
+        fallbackBuffers.resize(static_cast<size_t>(BATCH_SIZE) * MAX_DATAGRAM_SIZE);
+        return true;
+    }
+
+    void Close() {
+        if (sock != INVALID_SOCKET) {
+            closesocket(sock); // 요청 큐는 소켓을 닫을 때 같이 없어짐
+            sock = INVALID_SOCKET;
+        }
+        if (registeredIo) {
+            registeredIo = false;
+            rio.RIOCloseCompletionQueue(completionQueue);
+            rio.RIODeregisterBuffer(bufferId);
+        }
+        if (event != WSA_INVALID_EVENT) {
+            WSACloseEvent(event);
+            event = WSA_INVALID_EVENT;
+        }
+        if (slots != nullptr) {
+            VirtualFree(slots, 0, MEM_RELEASE);
+            slots = nullptr;
+        }
+        ready.clear();
+        handedOut.clear();
+    }
+
+    bool IsRegisteredIo() const {
+        return registeredIo;
+    }
+
+    // 같은 소켓으로 다른 스레드에서 보내는 송신기 (스레드마다 하나씩 받음, Close 전까지 유효)
+    UdpSender Sender() const;
+
+    // 받은 데이터그램을 최대 max 개까지 out 에 채우고 개수를 반환 (하나도 없으면 timeoutMs 까지, 또는 wake 가 켜질 때까지 기다림)
+    // 이전 Receive 가 돌려준 데이터는 이 호출에서 다시 받기 버퍼로 돌아가므로 그 전에 다 처리해야 함
+    int Receive(Datagram* out, int max, int timeoutMs, HANDLE wake = nullptr) {
+        if (!registeredIo) {
+            return ReceiveFallback(out, max, timeoutMs, wake);
+        }
+
+        RepostReceives();
+        if (ready.empty()) {
+            Dequeue();
+        }
+        if (ready.empty() && timeoutMs != 0) {
+            // 완료가 생기면 이벤트가 켜지도록 요청하고 기다림 (이미 완료가 있으면 바로 켜짐)
+            rio.RIONotify(completionQueue);
+            Wait(timeoutMs, wake);
+            Dequeue();
+        }
+
+        int count = 0;
+        for (; count < max && count < static_cast<int>(ready.size()); count++) {
+            const Completed& completed = ready[count];
+            Slot& slot = slots[completed.slot];
+            out[count].data = slot.data;
+            out[count].size = static_cast<int>(completed.size);
+            out[count].from = slot.address.Ipv4;
+            handedOut.push_back(completed.slot);
+        }
+        ready.erase(ready.begin(), ready.begin() + count);
+        return count;
+    }
+
+private:
+    // RIO 에 등록하는 받기 버퍼 한 칸 (데이터와 보낸 쪽 주소, 요청 문맥 값이 칸 번호)
+    struct Slot {
+        char data[MAX_DATAGRAM_SIZE];
+        SOCKADDR_INET address;
+    };
+
+    struct Completed {
+        uint32_t slot;
+        ULONG size;
+    };
+
+    SOCKET sock = INVALID_SOCKET;
+    bool registeredIo = false;
+    RIO_EXTENSION_FUNCTION_TABLE rio = {};
+    RIO_CQ completionQueue = RIO_INVALID_CQ;
+    RIO_RQ requestQueue = RIO_INVALID_RQ;
+    RIO_BUFFERID bufferId = RIO_INVALID_BUFFERID;
+    WSAEVENT event = WSA_INVALID_EVENT;
+    Slot* slots = nullptr;
+
+    std::vector<Completed> ready;         // 받았지만 아직 돌려주지 않은 데이터그램
+    std::vector<uint32_t> handedOut;      // 마지막 Receive 가 돌려준 칸 (다음 Receive 에서 다시 받기 요청을 검)
+
+    std::vector<char> fallbackBuffers;    // RIO 가 아닐 때 받기 버퍼 (BATCH_SIZE 칸)
+
+    bool Bind(uint16_t port) {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        return bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != SOCKET_ERROR;
+    }
+
+    bool OpenRegisteredIo() {
+        GUID functionTableId = WSAID_MULTIPLE_RIO;
+        DWORD bytes = 0;
+        rio.cbSize = sizeof(rio);
+        if (WSAIoctl(sock, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER, &functionTableId, sizeof(functionTableId), &rio, sizeof(rio), &bytes, nullptr, nullptr) == SOCKET_ERROR) {
+            return false;
+        }
+
+        // 버퍼 전체를 한 번에 등록 (페이지 단위로 잠기므로 VirtualAlloc 으로 받음)
+        slots = static_cast<Slot*>(VirtualAlloc(nullptr, sizeof(Slot) * RECEIVE_SLOTS, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        if (slots == nullptr) {
+            return false;
+        }
+        bufferId = rio.RIORegisterBuffer(reinterpret_cast<char*>(slots), static_cast<DWORD>(sizeof(Slot) * RECEIVE_SLOTS));
+        if (bufferId == RIO_INVALID_BUFFERID) {
+            return false;
+        }
+
+        event = WSACreateEvent();
+        if (event == WSA_INVALID_EVENT) {
+            rio.RIODeregisterBuffer(bufferId);
+            return false;
+        }
+        RIO_NOTIFICATION_COMPLETION notification = {};
+        notification.Type = RIO_EVENT_COMPLETION;
+        notification.Event.EventHandle = event;
+        notification.Event.NotifyReset = TRUE;
+        completionQueue = rio.RIOCreateCompletionQueue(RECEIVE_SLOTS, &notification);
+        if (completionQueue == RIO_INVALID_CQ) {
+            rio.RIODeregisterBuffer(bufferId);
+            return false;
+        }
+        // 이 요청 큐로는 보내지 않으므로 송신 쪽은 최소값으로 둠 (완료 큐도 받기 요청 수만큼만)
+        requestQueue = rio.RIOCreateRequestQueue(sock, RECEIVE_SLOTS, 1, 1, 1, completionQueue, completionQueue, nullptr);
+        if (requestQueue == RIO_INVALID_RQ) {
+            rio.RIOCloseCompletionQueue(completionQueue);
+            rio.RIODeregisterBuffer(bufferId);
+            return false;
+        }
+        registeredIo = true;
+
+        for (uint32_t i = 0; i < RECEIVE_SLOTS; i++) {
+            handedOut.push_back(i);
+        }
+        RepostReceives();
+        return true;
+    }
+
+    RIO_BUF DataBuffer(uint32_t index, ULONG length) const {
+        RIO_BUF buffer;
+        buffer.BufferId = bufferId;
+        buffer.Offset = static_cast<ULONG>(sizeof(Slot) * index + offsetof(Slot, data));
+        buffer.Length = length;
+        return buffer;
+    }
+
+    RIO_BUF AddressBuffer(uint32_t index) const {
+        RIO_BUF buffer;
+        buffer.BufferId = bufferId;
+        buffer.Offset = static_cast<ULONG>(sizeof(Slot) * index + offsetof(Slot, address));
+        buffer.Length = sizeof(SOCKADDR_INET);
+        return buffer;
+    }
+
+    // 돌려준 받기 칸에 다시 받기 요청을 걸고 한 번에 넘김
+    void RepostReceives() {
+        if (handedOut.empty()) {
+            return;
+        }
+        for (uint32_t index : handedOut) {
+            RIO_BUF dataBuffer = DataBuffer(index, MAX_DATAGRAM_SIZE);
+            RIO_BUF addressBuffer = AddressBuffer(index);
+            rio.RIOReceiveEx(requestQueue, &dataBuffer, 1, nullptr, &addressBuffer, nullptr, nullptr, RIO_MSG_DEFER, reinterpret_cast<void*>(static_cast<uintptr_t>(index)));
+        }
+        rio.RIOReceiveEx(requestQueue, nullptr, 0, nullptr, nullptr, nullptr, nullptr, RIO_MSG_COMMIT_ONLY, nullptr);
+        handedOut.clear();
+    }
+
+    // 완료 큐를 비워서 받은 것을 ready 로 옮김
+    void Dequeue() {
+        RIORESULT results[BATCH_SIZE];
+        while (true) {
+            ULONG count = rio.RIODequeueCompletion(completionQueue, results, BATCH_SIZE);
+            if (count == 0 || count == RIO_CORRUPT_CQ) {
+                return;
+            }
+            for (ULONG i = 0; i < count; i++) {
+                uint32_t index = static_cast<uint32_t>(results[i].RequestContext);
+                if (results[i].Status == 0 && slots[index].address.si_family == AF_INET) {
+                    ready.push_back({ index, results[i].BytesTransferred });
+                }
+                else {
+                    handedOut.push_back(index); // 실패했거나 (너무 큰 데이터그램 등) IPv4 가 아니면 버리고 다시 받음
+                }
+            }
+            if (count < BATCH_SIZE) {
+                return;
+            }
+        }
+    }
+
+    // 받기 이벤트나 wake 중 하나가 켜지거나 timeoutMs 가 지날 때까지 기다림
+    void Wait(int timeoutMs, HANDLE wake) {
+        HANDLE handles[2] = { event, wake };
+        WaitForMultipleObjects(wake != nullptr ? 2 : 1, handles, FALSE, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+    }
+
+    int ReceiveFallback(Datagram* out, int max, int timeoutMs, HANDLE wake) {
+        if (max > BATCH_SIZE) {
+            max = BATCH_SIZE;
+        }
+        if (timeoutMs != 0) {
+            Wait(timeoutMs, wake);
+        }
+        WSAResetEvent(event); // 아래에서 recvfrom 을 부르면 그 뒤에 오는 데이터그램에 대해 다시 켜짐
+
+        int count = 0;
+        while (count < max) {
+            char* buffer = fallbackBuffers.data() + static_cast<size_t>(count) * MAX_DATAGRAM_SIZE;
+            int addressSize = sizeof(out[count].from);
+            int received = recvfrom(sock, buffer, MAX_DATAGRAM_SIZE, 0, reinterpret_cast<sockaddr*>(&out[count].from), &addressSize);
+            if (received == SOCKET_ERROR) {
+                int error = WSAGetLastError();
+                if (error == WSAECONNRESET || error == WSAEMSGSIZE) {
+                    continue; // 이전 송신의 ICMP 포트 도달 불가 알림이나 너무 큰 데이터그램은 건너뜀
+                }
+                break; // WSAEWOULDBLOCK: 다 받음
+            }
+            out[count].data = buffer;
+            out[count].size = received;
+            count++;
+        }
+        return count;
+    }
+};
+
+// UdpBatch 의 소켓으로 다른 스레드 (워커) 가 바로 보내는 송신기
+// RIO 요청 큐는 소켓마다 하나뿐이고 스레드 안전하지 않으므로 RIO 대신 sendto 로 보냄 (RIO 소켓도 일반 Winsock 함수를 쓸 수 있음)
+// 같은 소켓에 여러 스레드가 동시에 sendto 해도 되므로 워커마다 하나씩 두면 보내기가 코어 수만큼 나뉨
+class UdpSender {
+public:
+    explicit UdpSender(SOCKET sock) : sock(sock) {}
+
+    // 바로 보냄 (송신 버퍼가 차서 실패하면 버리고 false, UDP 이므로 다음 상태가 곧 다시 감)
+    bool Send(const sockaddr_in& to, const char* data, size_t size) const {
+        if (size > UdpBatch::MAX_DATAGRAM_SIZE) {
+            return false;
+        }
+        return sendto(sock, data, static_cast<int>(size), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to)) != SOCKET_ERROR;
+    }
+
+private:
+    SOCKET sock;
+};
+
+inline UdpSender UdpBatch::Sender() const {
+    return UdpSender(sock);
+}